@@ -0,0 +1,221 @@
+/*
+    Holds a number of idle, authenticated loopback connections and reports
+    the service's resident memory per connection.
+
+    Usage: libnetwrk_bench_connections [connections = 100000]
+
+    Clients live in a forked process so only the service side is measured.
+    Clients spread over 127.0.0.x destinations to stay within the ephemeral port range.
+*/
+
+#include <libnetwrk.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace libnetwrk;
+using namespace libnetwrk::tcp;
+
+enum class commands : unsigned int {
+    none
+};
+
+struct bench_desc {
+    using command_t = commands;
+    using storage_t = libnetwrk::nothing;
+};
+
+using message_t = message<bench_desc>;
+
+class bench_service : public tcp_service<bench_desc> {
+public:
+    size_t connections() {
+        return m_comp_connection.connections.size();
+    }
+
+    static constexpr size_t connection_size() {
+        return sizeof(connection_internal_t);
+    }
+};
+
+static constexpr size_t connections_per_address = 20000U;
+
+static size_t get_rss_bytes() {
+    std::ifstream status("/proc/self/status");
+    std::string   line;
+
+    while (std::getline(status, line)) {
+        if (line.rfind("VmRSS:", 0) == 0)
+            return std::strtoull(line.c_str() + 6, nullptr, 10) * 1024U;
+    }
+
+    return 0U;
+}
+
+static size_t raise_fd_limit() {
+    rlimit limit{};
+    getrlimit(RLIMIT_NOFILE, &limit);
+
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+
+    return limit.rlim_cur;
+}
+
+/*
+    Connect and answer the auth challenge, then hold the sockets until the parent closes the pipe.
+*/
+static int run_clients(size_t count, int port_fd, int ready_fd) {
+    uint16_t port = 0U;
+    if (read(port_fd, &port, sizeof(port)) != sizeof(port))
+        return 1;
+
+    asio::io_context                   context;
+    std::vector<asio::ip::tcp::socket> sockets;
+    sockets.reserve(count);
+
+    for (size_t i = 0; i < count; i++) {
+        auto address = asio::ip::address_v4(0x7F000001U + static_cast<uint32_t>(i / connections_per_address));
+
+        std::error_code ec;
+        auto& socket = sockets.emplace_back(context);
+        socket.connect({ address, port }, ec);
+
+        if (ec) {
+            std::fprintf(stderr, "Connection %zu failed. | %s\n", i, ec.message().c_str());
+            return 1;
+        }
+
+        message_t request;
+        fixed_buffer<message_t::message_head_t::size> head_buffer;
+
+        asio::read(socket, asio::buffer(head_buffer.data(), head_buffer.size()), ec);
+        get_buffer_write_index(head_buffer) = head_buffer.size();
+        request.head.deserialize(head_buffer);
+
+        request.data.underlying().resize(request.head.data_size);
+        asio::read(socket, asio::buffer(request.data.data(), request.data.size()), ec);
+
+        authentication::request_t auth_request{};
+        request >> auth_request;
+
+        message_t response;
+        response.head.type    = message_type::system;
+        response.head.command = static_cast<uint64_t>(system_command::c2s_verify);
+        response << authentication::generate_response(auth_request);
+
+    #ifndef LIBNETWRK_DISABLE_CRC
+        response.head.crc = crc32_compute(response.data.data(), response.head.data_size);
+    #endif
+
+        head_buffer.clear();
+        response.head.serialize(head_buffer);
+
+        std::vector<asio::const_buffer> buffers = {
+            asio::buffer(head_buffer.data(), head_buffer.size()),
+            asio::buffer(response.data.data(), response.data.size())
+        };
+
+        asio::write(socket, buffers, ec);
+
+        if (ec) {
+            std::fprintf(stderr, "Authentication %zu failed. | %s\n", i, ec.message().c_str());
+            return 1;
+        }
+    }
+
+    char ready = 1;
+    if (write(ready_fd, &ready, sizeof(ready)) != sizeof(ready))
+        return 1;
+
+    // Returns once the parent closes its end
+    [[maybe_unused]] auto closed = read(port_fd, &port, sizeof(port));
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    size_t count    = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000U;
+    size_t fd_limit = raise_fd_limit();
+
+    if (count + 64U > fd_limit) {
+        std::fprintf(stderr, "File descriptor limit is %zu, reducing to %zu connections.\n", fd_limit, fd_limit - 64U);
+        count = fd_limit - 64U;
+    }
+
+    int port_pipe[2];
+    int ready_pipe[2];
+
+    if (pipe(port_pipe) != 0 || pipe(ready_pipe) != 0)
+        return 1;
+
+    // Fork before the service starts any threads
+    pid_t child = fork();
+
+    if (child == 0) {
+        close(port_pipe[1]);
+        close(ready_pipe[0]);
+        std::exit(run_clients(count, port_pipe[0], ready_pipe[1]));
+    }
+
+    close(port_pipe[0]);
+    close(ready_pipe[1]);
+
+    bench_service service;
+    service.get_settings().heartbeat_interval_sec = 0U;
+    service.get_settings().auth_deadline_sec      = 255U;
+    service.get_settings().connection_pool_size   = 0U;
+
+    if (!service.start("0.0.0.0", 0)) {
+        kill(child, SIGKILL);
+        return 1;
+    }
+
+    service.process_messages_async();
+
+    // Let the io thread settle before taking the baseline
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    size_t baseline_rss = get_rss_bytes();
+
+    auto start = std::chrono::steady_clock::now();
+
+    uint16_t port  = service.get_port();
+    char     ready = 0;
+
+    if (write(port_pipe[1], &port, sizeof(port)) != sizeof(port) || read(ready_pipe[0], &ready, sizeof(ready)) != sizeof(ready)) {
+        std::fprintf(stderr, "Clients failed to connect.\n");
+        waitpid(child, nullptr, 0);
+        return 1;
+    }
+
+    while (service.connections() != count) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    // Pending verify_ok writes and auth deadlines settle
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    size_t rss = get_rss_bytes();
+
+    std::printf("connections:          %zu\n",     count);
+    std::printf("connect time:         %lld ms\n", static_cast<long long>(elapsed.count()));
+    std::printf("baseline rss:         %zu KiB\n", baseline_rss / 1024U);
+    std::printf("rss:                  %zu KiB\n", rss / 1024U);
+    std::printf("rss per connection:   %zu B\n",   rss > baseline_rss ? (rss - baseline_rss) / count : 0U);
+    std::printf("sizeof(connection):   %zu B\n",   bench_service::connection_size());
+
+    close(port_pipe[1]);
+    waitpid(child, nullptr, 0);
+
+    service.stop();
+    return 0;
+}
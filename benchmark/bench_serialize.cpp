@@ -0,0 +1,422 @@
+/*
+    Measures serialization speed.
+
+    Usage: libnetwrk_bench_serialize [--json] [iterations = 200]
+
+    Suite measures ns/op and bytes/op for every supported category against
+    dynamic_buffer and fixed_buffer, next to a memcpy of the same bytes.
+    Growing compares a plain dynamic_buffer, which grows as it is written,
+    with message::operator<<, which reserves the serialized size up front.
+    Both build a new buffer for every value, tiny values fit its inline storage.
+    Malformed compares rejecting truncated payloads by exception with try_deserialize.
+
+    --json prints the results as JSON instead, names are stable to diff across versions.
+*/
+
+#include <libnetwrk.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace libnetwrk;
+
+enum class commands : unsigned int {
+    none
+};
+
+struct bench_desc {
+    using command_t = commands;
+    using storage_t = libnetwrk::nothing;
+};
+
+using message_t      = message<bench_desc>;
+using fixed_buffer_t = fixed_buffer<16384>;
+
+// Minimum time spent measuring one operation
+static constexpr std::chrono::milliseconds measure_time(20);
+
+/*
+    Stands in for a struct with 50 fields written one by one.
+*/
+struct wide_struct {
+    uint64_t fields[50] = {};
+
+    template<typename Buffer>
+    void serialize(Buffer& buffer) const {
+        for (auto field : fields)
+            buffer << field;
+    }
+
+    template<typename Buffer>
+    void deserialize(Buffer& buffer) {
+        for (auto& field : fields)
+            buffer >> field;
+    }
+
+    size_t serialized_size() const {
+        return sizeof(fields);
+    }
+};
+
+/*
+    Same fields, copied as raw bytes.
+*/
+struct wide_pod {
+    uint64_t fields[50] = {};
+};
+
+template<>
+inline constexpr bool libnetwrk::serialize_as_bytes<wide_pod> = true;
+
+/*
+    Typical message payload.
+*/
+struct user_struct {
+    uint32_t           id     = 42U;
+    std::string        name   = "player name";
+    std::vector<float> scores = { 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f };
+    bool               active = true;
+
+    template<typename Buffer>
+    void serialize(Buffer& buffer) const {
+        buffer << id << name << scores << active;
+    }
+
+    template<typename Buffer>
+    void deserialize(Buffer& buffer) {
+        buffer >> id >> name >> scores >> active;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// SUITE
+
+static const void* volatile escaped = nullptr;
+
+/*
+    Keep the compiler from dropping work whose result is never read.
+*/
+template<typename Type>
+static void escape(const Type& value) {
+    escaped = &value;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+template<typename Operation>
+static double measure_ns(Operation&& operation) {
+    uint64_t ops = 0U;
+
+    operation();
+
+    auto start   = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::steady_clock::duration{};
+
+    do {
+        for (uint32_t i = 0; i < 16U; i++)
+            operation();
+
+        ops    += 16U;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed < measure_time);
+
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / ops;
+}
+
+struct case_result {
+    const char* name           = "";
+    const char* category       = "";
+    const char* buffer         = "";
+    uint32_t    bytes          = 0U;
+    double      serialize_ns   = 0.0;
+    double      deserialize_ns = 0.0;
+    double      memcpy_ns      = 0.0;
+};
+
+template<typename Buffer, typename Value>
+static case_result run_case(Buffer& buffer, const char* buffer_name, const char* category, const char* name, const Value& value) {
+    case_result result{ name, category, buffer_name };
+
+    result.serialize_ns = measure_ns([&] {
+        buffer.clear();
+        buffer << value;
+        escape(buffer);
+    });
+
+    buffer.clear();
+    buffer << value;
+    result.bytes = serialize::internal::written(buffer);
+
+    result.deserialize_ns = measure_ns([&] {
+        Value copy{};
+
+        get_buffer_read_index(buffer) = 0U;
+        buffer >> copy;
+        escape(copy);
+    });
+
+    std::vector<uint8_t> destination(result.bytes);
+
+    result.memcpy_ns = measure_ns([&] {
+        std::memcpy(destination.data(), buffer.data(), result.bytes);
+        escape(destination);
+    });
+
+    return result;
+}
+
+template<typename Buffer>
+static void run_suite(Buffer& buffer, const char* buffer_name, std::vector<case_result>& results) {
+    std::vector<uint32_t>                     numbers;
+    std::vector<std::string>                  strings;
+    std::deque<uint32_t>                      deque;
+    std::list<uint32_t>                       list;
+    std::set<uint32_t>                        set;
+    std::unordered_set<uint32_t>              unordered_set;
+    std::map<uint32_t, std::string>           map;
+    std::unordered_map<uint32_t, std::string> unordered_map;
+    std::array<uint64_t, 16>                  array = {};
+
+    for (uint32_t i = 0; i < 1000U; i++) {
+        numbers.push_back(i);
+        deque.push_back(i);
+        list.push_back(i);
+        set.insert(i);
+        unordered_set.insert(i);
+    }
+
+    for (uint32_t i = 0; i < 100U; i++) {
+        strings.push_back("string " + std::to_string(i));
+        map[i]           = "value " + std::to_string(i);
+        unordered_map[i] = "value " + std::to_string(i);
+    }
+
+    auto add = [&](const char* category, const char* name, const auto& value) {
+        results.push_back(run_case(buffer, buffer_name, category, name, value));
+    };
+
+    add("primitive",  "uint32_t",                                       uint32_t(123456U));
+    add("primitive",  "double",                                         3.14159);
+    add("string",     "std::string x 64",                               std::string(64U, 'x'));
+    add("contiguous", "std::vector<uint32_t> x 1000",                   numbers);
+    add("contiguous", "std::vector<std::string> x 100",                 strings);
+    add("contiguous", "std::array<uint64_t, 16>",                       array);
+    add("node",       "std::deque<uint32_t> x 1000",                    deque);
+    add("node",       "std::list<uint32_t> x 1000",                     list);
+    add("node",       "std::set<uint32_t> x 1000",                      set);
+    add("node",       "std::unordered_set<uint32_t> x 1000",            unordered_set);
+    add("kvp",        "std::map<uint32_t, std::string> x 100",          map);
+    add("kvp",        "std::unordered_map<uint32_t, std::string> x 100", unordered_map);
+    add("user",       "user_struct",                                    user_struct{});
+    add("user",       "wide_struct",                                    wide_struct{});
+    add("user",       "wide_pod",                                       wide_pod{});
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// RESERVE
+
+struct reserve_result {
+    const char* name        = "";
+    double      growing_ns  = 0.0;
+    double      reserved_ns = 0.0;
+};
+
+template<typename Value>
+static reserve_result run_reserve(const char* name, const Value& value, uint32_t iterations) {
+    reserve_result result{ name };
+    size_t         sink = 0U;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        dynamic_buffer buffer;
+        buffer << value;
+        sink += buffer.size();
+    }
+
+    auto growing = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        message_t message;
+        message << value;
+        sink += message.data.size();
+    }
+
+    auto reserved = std::chrono::steady_clock::now();
+
+    if (sink == 0U)
+        std::fprintf(stderr, "nothing serialized\n");
+
+    result.growing_ns  = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(growing - start).count()) / iterations;
+    result.reserved_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(reserved - growing).count()) / iterations;
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MALFORMED
+
+struct malformed_result {
+    double throwing_ns   = 0.0;
+    double error_code_ns = 0.0;
+};
+
+static malformed_result run_malformed(uint32_t iterations) {
+    malformed_result         result;
+    std::vector<std::string> value;
+    size_t                   rejected = 0U;
+
+    // Claims 8 strings, holds 1
+    dynamic_buffer buffer;
+    buffer << uint32_t(8) << std::string("truncated");
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        get_buffer_read_index(buffer) = 0U;
+
+        try {
+            buffer >> value;
+        }
+        catch (const libnetwrk_exception&) {
+            rejected++;
+        }
+    }
+
+    auto throwing = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        get_buffer_read_index(buffer) = 0U;
+
+        if (serialize::try_deserialize(buffer, value) != deserialize_error::none)
+            rejected++;
+    }
+
+    auto error_code = std::chrono::steady_clock::now();
+
+    if (rejected != 2U * iterations)
+        std::fprintf(stderr, "malformed payload accepted\n");
+
+    result.throwing_ns   = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(throwing - start).count()) / iterations;
+    result.error_code_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(error_code - throwing).count()) / iterations;
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// OUTPUT
+
+static void print_duration(const char* label, double ns) {
+    if (ns < 1000.0)
+        std::printf("  %-20s%.1f ns\n", label, ns);
+    else
+        std::printf("  %-20s%.1f us\n", label, ns / 1000.0);
+}
+
+static void print_text(uint32_t iterations, const std::vector<case_result>& cases,
+                       const std::vector<reserve_result>& reserves, const malformed_result& malformed)
+{
+    std::printf("%-16s %-12s %-50s %8s %14s %14s %12s\n", "buffer", "category", "case", "bytes", "serialize ns", "deserialize ns", "memcpy ns");
+
+    for (auto& result : cases) {
+        std::printf("%-16s %-12s %-50s %8u %14.1f %14.1f %12.1f\n", result.buffer, result.category, result.name,
+                    result.bytes, result.serialize_ns, result.deserialize_ns, result.memcpy_ns);
+    }
+
+    std::printf("\niterations:           %u\n", iterations);
+
+    for (auto& result : reserves) {
+        std::printf("%s\n", result.name);
+        print_duration("growing:", result.growing_ns);
+        print_duration("reserved:", result.reserved_ns);
+        std::printf("  speedup:            %.2fx\n",   result.growing_ns / result.reserved_ns);
+    }
+
+    std::printf("malformed std::vector<std::string>\n");
+    std::printf("  throwing:           %.1f ns\n", malformed.throwing_ns);
+    std::printf("  try_deserialize:    %.1f ns\n", malformed.error_code_ns);
+}
+
+static void print_json(uint32_t iterations, const std::vector<case_result>& cases,
+                       const std::vector<reserve_result>& reserves, const malformed_result& malformed)
+{
+    std::printf("{\n  \"iterations\": %u,\n  \"suite\": [\n", iterations);
+
+    for (size_t i = 0; i < cases.size(); i++) {
+        auto& result = cases[i];
+
+        std::printf("    { \"buffer\": \"%s\", \"category\": \"%s\", \"name\": \"%s\", \"bytes_per_op\": %u, "
+                    "\"serialize_ns\": %.2f, \"deserialize_ns\": %.2f, \"memcpy_ns\": %.2f }%s\n",
+                    result.buffer, result.category, result.name, result.bytes,
+                    result.serialize_ns, result.deserialize_ns, result.memcpy_ns, i + 1U < cases.size() ? "," : "");
+    }
+
+    std::printf("  ],\n  \"reserve\": [\n");
+
+    for (size_t i = 0; i < reserves.size(); i++) {
+        auto& result = reserves[i];
+
+        std::printf("    { \"name\": \"%s\", \"growing_ns\": %.2f, \"reserved_ns\": %.2f }%s\n",
+                    result.name, result.growing_ns, result.reserved_ns, i + 1U < reserves.size() ? "," : "");
+    }
+
+    std::printf("  ],\n  \"malformed\": { \"throwing_ns\": %.2f, \"try_deserialize_ns\": %.2f }\n}\n",
+                malformed.throwing_ns, malformed.error_code_ns);
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t iterations = 200U;
+    bool     json       = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--json") == 0)
+            json = true;
+        else
+            iterations = static_cast<uint32_t>(std::strtoul(argv[i], nullptr, 10));
+    }
+
+    std::vector<case_result> cases;
+
+    {
+        dynamic_buffer dynamic;
+        fixed_buffer_t fixed;
+
+        run_suite(dynamic, "dynamic_buffer", cases);
+        run_suite(fixed, "fixed_buffer", cases);
+    }
+
+    std::map<uint32_t, std::string> map;
+    std::vector<std::string>        strings;
+    std::vector<wide_struct>        structs(1000);
+    std::vector<wide_pod>           pods(1000);
+
+    for (uint32_t i = 0; i < 10000U; i++) {
+        map[i] = "value " + std::to_string(i);
+        strings.push_back("string " + std::to_string(i));
+    }
+
+    std::vector<reserve_result> reserves;
+    reserves.push_back(run_reserve("uint32_t", uint32_t(7U), iterations * 1000U));
+    reserves.push_back(run_reserve("std::map<uint32_t, std::string> x 10000", map, iterations));
+    reserves.push_back(run_reserve("std::vector<std::string> x 10000", strings, iterations));
+    reserves.push_back(run_reserve("std::vector<wide_struct> x 1000", structs, iterations));
+    reserves.push_back(run_reserve("std::vector<wide_pod> x 1000", pods, iterations));
+
+    auto malformed = run_malformed(iterations * 1000U);
+
+    if (json)
+        print_json(iterations, cases, reserves, malformed);
+    else
+        print_text(iterations, cases, reserves, malformed);
+
+    return 0;
+}
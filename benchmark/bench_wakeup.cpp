@@ -0,0 +1,135 @@
+/*
+    Measures the cost of waking the connection writer on every send.
+
+    Usage: libnetwrk_bench_wakeup [sends = 1000000]
+
+    A producer thread queues and notifies like direct_send, while a writer
+    coroutine on the io thread drains and waits like co_write.
+    Burst sends back to back, paced waits for each send to be drained
+    so every send has to wake an idle writer.
+
+    Runs async_event and timer_event, the steady_timer wake up it replaced.
+    Timers aren't thread safe, so timer_event posts its notifies to the io thread.
+*/
+
+#include <libnetwrk.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+using namespace libnetwrk;
+
+/*
+    Wakes by cancelling a timer that never expires.
+*/
+class timer_event {
+public:
+    timer_event(asio::io_context& context)
+        : m_io_context(context), m_timer(context, asio::steady_timer::duration::max()) {}
+
+public:
+    asio::awaitable<void> wait() {
+        co_await m_timer.async_wait(asio::as_tuple(asio::use_awaitable));
+    }
+
+    void notify_one() {
+        asio::post(m_io_context, [this] { m_timer.cancel_one(); });
+    }
+
+    void notify_all() {
+        asio::post(m_io_context, [this] { m_timer.cancel(); });
+    }
+
+private:
+    asio::io_context&  m_io_context;
+    asio::steady_timer m_timer;
+};
+
+template<typename Event>
+struct bench_state {
+    bench_state(asio::io_context& context)
+        : event(context) {}
+
+    Event                event;
+    std::atomic_uint64_t queued  = 0U;
+    std::atomic_uint64_t drained = 0U;
+    std::atomic_bool     done    = false;
+    uint64_t             wakeups = 0U;
+};
+
+template<typename Event>
+static asio::awaitable<void> co_writer(bench_state<Event>& state) {
+    while (!state.done) {
+        if (state.drained == state.queued) {
+            co_await state.event.wait();
+            state.wakeups++;
+        }
+
+        state.drained = state.queued.load();
+    }
+}
+
+struct bench_result {
+    uint64_t wakeups   = 0U;
+    int64_t  notify_ns = 0;
+    int64_t  total_ns  = 0;
+};
+
+template<typename Event>
+static bench_result run(uint64_t sends, bool paced) {
+    asio::io_context   context(1);
+    bench_state<Event> state(context);
+
+    asio::co_spawn(context, co_writer(state), asio::detached);
+    std::thread io_thread([&context] { context.run(); });
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint64_t i = 0; i < sends; i++) {
+        state.queued++;
+        state.event.notify_one();
+
+        while (paced && state.drained != i + 1U)
+            std::this_thread::yield();
+    }
+
+    auto notified = std::chrono::steady_clock::now();
+
+    while (state.drained != sends)
+        std::this_thread::yield();
+
+    auto finished = std::chrono::steady_clock::now();
+
+    state.done = true;
+    state.event.notify_all();
+    context.stop();
+    io_thread.join();
+
+    return {
+        state.wakeups,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(notified - start).count(),
+        std::chrono::duration_cast<std::chrono::nanoseconds>(finished - start).count()
+    };
+}
+
+static void print(const char* name, uint64_t sends, const bench_result& result) {
+    std::printf("%s\n", name);
+    std::printf("  writer wake ups:    %llu\n",    static_cast<unsigned long long>(result.wakeups));
+    std::printf("  sending per send:   %.1f ns\n", static_cast<double>(result.notify_ns) / sends);
+    std::printf("  drained per send:   %.1f ns\n", static_cast<double>(result.total_ns) / sends);
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t sends = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000U;
+
+    std::printf("sends:                %llu\n", static_cast<unsigned long long>(sends));
+    print("async_event burst", sends, run<async_event>(sends, false));
+    print("async_event paced", sends, run<async_event>(sends, true));
+    print("timer_event burst", sends, run<timer_event>(sends, false));
+    print("timer_event paced", sends, run<timer_event>(sends, true));
+
+    return 0;
+}
@@ -1,32 +1,97 @@
 #pragma once
 
 #include "libnetwrk/exceptions/libnetwrk_exception.hpp"
+#include "libnetwrk/net/enum/enums.hpp"
 
+#include <concepts>
 #include <cstdint>
 
 namespace libnetwrk {
+    /*
+        Bounds on what deserializing from a buffer may allocate, 0 disables a limit.
+        Length prefixes are always checked against the bytes left in the buffer.
+    */
+    struct deserialize_limits {
+        uint32_t max_elements         = 0U;     // Characters or elements in a single string or container
+        uint32_t max_allocation       = 0U;     // Bytes strings and containers may allocate in one deserialize call
+        uint32_t max_allocation_ratio = 0U;     // Same as max_allocation, as a multiple of the buffer's data size
+    };
+
+    /*
+        State of one deserialize call, kept on its stack. Values deserialized by user types
+        from inside the call share it, so errors and allocations add up across them.
+    */
+    struct decode_state {
+        const deserialize_limits* limits    = nullptr;
+        uint64_t                  allocated = 0U;                          // Bytes allocated by strings and containers
+        deserialize_error         error     = deserialize_error::none;     // First error
+        bool                      throws    = true;                        // Errors throw unless cleared by try_deserialize
+    };
+
+    /*
+        Read position and encoding shared by all buffers.
+
+        Not polymorphic, buffers are used through templates constrained by is_buffer,
+        so data() and size() are direct calls and buffers carry no vtable pointer.
+        Deserialization state lives with the call, not here, see decode_state.
+    */
     class buffer {
     public:
         using value_t = uint8_t;
 
-    public:
-        buffer()              = default;
-        buffer(const buffer&) = default;
-        buffer(buffer&&)      = default;
+    protected:
+        buffer()  = default;
+        ~buffer() = default;
 
-        buffer& operator=(const buffer&) = default;
-        buffer& operator=(buffer&&)      = default;
+        // A deserialize call in progress stays with its buffer
+        buffer(const buffer& other)
+            : m_read_index(other.m_read_index), m_compact(other.m_compact) {}
+
+        buffer& operator=(const buffer& other) {
+            m_read_index = other.m_read_index;
+            m_compact    = other.m_compact;
+            return *this;
+        }
 
     public:
-        virtual value_t* data()  = 0;
-        virtual uint32_t size()  = 0;
-        virtual void     clear() = 0;
+        /*
+            Compact buffers write integers and length prefixes as varints.
+            Both ends must agree on the encoding.
+        */
+        void set_compact(bool compact) {
+            m_compact = compact;
+        }
+
+        bool is_compact() const {
+            return m_compact;
+        }
 
         friend uint32_t& get_buffer_read_index(buffer& buffer) {
             return buffer.m_read_index;
         }
 
+        /*
+            Deserialize call in progress, null outside of one.
+        */
+        friend decode_state*& get_buffer_decode_state(buffer& buffer) {
+            return buffer.m_decode_state;
+        }
+
     protected:
-        uint32_t m_read_index = 0U;
+        uint32_t      m_read_index   = 0U;
+        bool          m_compact      = false;
+        decode_state* m_decode_state = nullptr;
+    };
+
+    /*
+        Buffer the serializer can read from and write to.
+    */
+    template<typename Buffer>
+    concept is_buffer = requires(Buffer& buffer) {
+        requires std::derived_from<Buffer, libnetwrk::buffer>;
+
+        { buffer.data()  } -> std::same_as<libnetwrk::buffer::value_t*>;
+        { buffer.size()  } -> std::convertible_to<uint32_t>;
+        { buffer.clear() } -> std::same_as<void>;
     };
 }
@@ -0,0 +1,437 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <utility>
+
+// Bytes stored inside the buffer before it allocates, 0 to always allocate.
+// Must be the same in every translation unit. Buffer and message types live in an inline
+// namespace named after it, so translation units passing them to each other with
+// different sizes fail to link.
+#ifndef LIBNETWRK_BUFFER_INLINE_SIZE
+    #define LIBNETWRK_BUFFER_INLINE_SIZE 32
+#endif
+
+#define LIBNETWRK_STRINGIZE_(value) #value
+#define LIBNETWRK_STRINGIZE(value)  LIBNETWRK_STRINGIZE_(value)
+
+#define LIBNETWRK_CONCAT_(lhs, rhs) lhs##rhs
+#define LIBNETWRK_CONCAT(lhs, rhs)  LIBNETWRK_CONCAT_(lhs, rhs)
+
+#define LIBNETWRK_BUFFER_NAMESPACE LIBNETWRK_CONCAT(inline_size_, LIBNETWRK_BUFFER_INLINE_SIZE)
+
+#ifdef _MSC_VER
+    #pragma detect_mismatch("LIBNETWRK_BUFFER_INLINE_SIZE", LIBNETWRK_STRINGIZE(LIBNETWRK_BUFFER_INLINE_SIZE))
+#endif
+
+namespace libnetwrk::inline LIBNETWRK_BUFFER_NAMESPACE {
+    /*
+        memcpy for copies whose size may be a constant after inlining. GCC expands constant copies
+        over 256 bytes as rep movs, a few times slower than the library call at a few hundred bytes
+        and slower still into unaligned buffers.
+    */
+    inline void copy_bytes(void* destination, const void* source, size_t size) {
+    #if defined(__GNUC__)
+        // Hide the size from the optimizer, so the library call is made
+        if (size > 256U)
+            __asm__("" : "+r"(size));
+    #endif
+
+        std::memcpy(destination, source, size);
+    }
+
+    /*
+        Growable byte array allocated from a memory resource.
+
+        Up to inline_capacity bytes are stored in the array itself, most messages never allocate.
+        std::pmr::vector<uint8_t> copies byte by byte through its allocator,
+        bytes here are always copied with memcpy.
+        Copies use the default resource, moves take the source's resource along,
+        so a moved-to array may point into an arena. Moving inline bytes copies them.
+
+        Has the std::vector<uint8_t> members buffers used to expose through underlying().
+        Iterators are pointers and there's no allocator_type.
+    */
+    class byte_vector {
+    public:
+        using value_type      = uint8_t;
+        using size_type       = size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference       = value_type&;
+        using const_reference = const value_type&;
+        using pointer         = value_type*;
+        using const_pointer   = const value_type*;
+        using iterator        = value_type*;
+        using const_iterator  = const value_type*;
+
+        static constexpr size_type inline_capacity = LIBNETWRK_BUFFER_INLINE_SIZE;
+
+    public:
+        byte_vector()
+            : byte_vector(std::pmr::get_default_resource()) {}
+
+        explicit byte_vector(std::pmr::memory_resource* resource)
+            : m_resource(resource), m_data(inline_data()), m_capacity(inline_capacity) {}
+
+        byte_vector(const byte_vector& other)
+            : byte_vector()
+        {
+            assign(other.m_data, other.m_size);
+        }
+
+        byte_vector(byte_vector&& other) noexcept
+            : m_resource(other.m_resource)
+        {
+            take(other);
+        }
+
+        ~byte_vector() {
+            deallocate();
+        }
+
+        byte_vector& operator=(const byte_vector& other) {
+            if (this != &other)
+                assign(other.m_data, other.m_size);
+
+            return *this;
+        }
+
+        byte_vector& operator=(byte_vector&& other) noexcept {
+            if (this == &other) return *this;
+
+            deallocate();
+
+            m_resource = other.m_resource;
+            take(other);
+            return *this;
+        }
+
+    public:
+        value_type* data() {
+            return m_data;
+        }
+
+        const value_type* data() const {
+            return m_data;
+        }
+
+        size_type size() const {
+            return m_size;
+        }
+
+        size_type capacity() const {
+            return m_capacity;
+        }
+
+        bool empty() const {
+            return m_size == 0U;
+        }
+
+        iterator begin() {
+            return m_data;
+        }
+
+        const_iterator begin() const {
+            return m_data;
+        }
+
+        iterator end() {
+            return m_data + m_size;
+        }
+
+        const_iterator end() const {
+            return m_data + m_size;
+        }
+
+        const_iterator cbegin() const {
+            return m_data;
+        }
+
+        const_iterator cend() const {
+            return m_data + m_size;
+        }
+
+        value_type& operator[](size_type index) {
+            return m_data[index];
+        }
+
+        const value_type& operator[](size_type index) const {
+            return m_data[index];
+        }
+
+        value_type& at(size_type index) {
+            if (index >= m_size)
+                throw std::out_of_range("byte_vector: index out of range.");
+
+            return m_data[index];
+        }
+
+        const value_type& at(size_type index) const {
+            if (index >= m_size)
+                throw std::out_of_range("byte_vector: index out of range.");
+
+            return m_data[index];
+        }
+
+        value_type& front() {
+            return m_data[0];
+        }
+
+        const value_type& front() const {
+            return m_data[0];
+        }
+
+        value_type& back() {
+            return m_data[m_size - 1U];
+        }
+
+        const value_type& back() const {
+            return m_data[m_size - 1U];
+        }
+
+        std::pmr::memory_resource* get_memory_resource() const {
+            return m_resource;
+        }
+
+        /*
+            Bytes are stored in the array itself.
+        */
+        bool is_inline() const {
+            return inline_capacity != 0U && m_data == m_inline.data();
+        }
+
+        void clear() {
+            m_size = 0U;
+        }
+
+        void reserve(size_type capacity) {
+            if (capacity > m_capacity)
+                reallocate(capacity);
+        }
+
+        /*
+            Move inline bytes to allocated storage, which follows the array on move.
+        */
+        void spill() {
+            if (is_inline())
+                reallocate(std::max<size_type>(m_size, inline_capacity * 2U));
+        }
+
+        /*
+            Added bytes are zeroed.
+        */
+        void resize(size_type size) {
+            if (size > m_size) {
+                make_room(size - m_size);
+                std::memset(m_data + m_size, 0, size - m_size);
+            }
+
+            m_size = size;
+        }
+
+        void resize(size_type size, value_type value) {
+            if (size > m_size) {
+                make_room(size - m_size);
+                std::memset(m_data + m_size, value, size - m_size);
+            }
+
+            m_size = size;
+        }
+
+        void push_back(value_type value) {
+            make_room(1U);
+            m_data[m_size++] = value;
+        }
+
+        void pop_back() {
+            m_size--;
+        }
+
+        void append(const value_type* data, size_type size) {
+            make_room(size);
+
+            if (size != 0U)
+                copy_bytes(m_data + m_size, data, size);
+
+            m_size += size;
+        }
+
+        void assign(const value_type* data, size_type size) {
+            m_size = 0U;
+            append(data, size);
+        }
+
+        template<std::input_iterator Iterator>
+        void assign(Iterator first, Iterator last) {
+            m_size = 0U;
+            insert(end(), first, last);
+        }
+
+        void assign(size_type count, value_type value) {
+            m_size = 0U;
+            resize(count, value);
+        }
+
+        void assign(std::initializer_list<value_type> values) {
+            assign(values.begin(), values.size());
+        }
+
+        iterator insert(const_iterator position, value_type value) {
+            return insert(position, 1U, value);
+        }
+
+        iterator insert(const_iterator position, size_type count, value_type value) {
+            size_type index = open_gap(position, count);
+
+            std::memset(m_data + index, value, count);
+            return m_data + index;
+        }
+
+        /*
+            Like std::vector, the range can't be in this array.
+        */
+        template<std::input_iterator Iterator>
+        iterator insert(const_iterator position, Iterator first, Iterator last) {
+            if constexpr (std::contiguous_iterator<Iterator> && sizeof(std::iter_value_t<Iterator>) == 1U) {
+                size_type count = static_cast<size_type>(last - first);
+                size_type index = open_gap(position, count);
+
+                if (count != 0U)
+                    std::memcpy(m_data + index, std::to_address(first), count);
+
+                return m_data + index;
+            }
+            else {
+                size_type index = static_cast<size_type>(position - m_data);
+                size_type tail  = m_size;
+
+                for (; first != last; ++first)
+                    push_back(static_cast<value_type>(*first));
+
+                std::rotate(m_data + index, m_data + tail, m_data + m_size);
+                return m_data + index;
+            }
+        }
+
+        iterator insert(const_iterator position, std::initializer_list<value_type> values) {
+            return insert(position, values.begin(), values.end());
+        }
+
+        iterator erase(const_iterator position) {
+            return erase(position, position + 1);
+        }
+
+        iterator erase(const_iterator first, const_iterator last) {
+            size_type index = static_cast<size_type>(first - m_data);
+            size_type count = static_cast<size_type>(last - first);
+
+            std::memmove(m_data + index, m_data + index + count, m_size - index - count);
+            m_size -= count;
+
+            return m_data + index;
+        }
+
+        void swap(byte_vector& other) noexcept {
+            byte_vector temporary(std::move(other));
+
+            other = std::move(*this);
+            *this = std::move(temporary);
+        }
+
+        friend bool operator==(const byte_vector& lhs, const byte_vector& rhs) {
+            return lhs.m_size == rhs.m_size && (lhs.m_size == 0U || std::memcmp(lhs.m_data, rhs.m_data, lhs.m_size) == 0);
+        }
+
+    private:
+        // Views into the data may hold any serialized element
+        static constexpr size_type alignment = alignof(std::max_align_t);
+
+        std::pmr::memory_resource* m_resource = nullptr;
+        value_type*                m_data     = nullptr;
+        size_type                  m_size     = 0U;
+        size_type                  m_capacity = 0U;
+
+        alignas(alignment) std::array<value_type, inline_capacity> m_inline;
+
+    private:
+        /*
+            Grow geometrically, like std::vector.
+        */
+        void make_room(size_type size) {
+            // Keeps the common path small enough to inline into every write
+            if (size > m_capacity - m_size) [[unlikely]]
+                reallocate(std::max(m_size + size, m_capacity * 2U));
+        }
+
+        /*
+            Make count bytes of room at position, moving the bytes after it.
+
+            @returns index of the gap
+        */
+        size_type open_gap(const_iterator position, size_type count) {
+            size_type index = static_cast<size_type>(position - m_data);
+
+            make_room(count);
+
+            if (index != m_size)
+                std::memmove(m_data + index + count, m_data + index, m_size - index);
+
+            m_size += count;
+            return index;
+        }
+
+        void reallocate(size_type capacity) {
+            auto data = static_cast<value_type*>(m_resource->allocate(capacity, alignment));
+
+            if (m_size != 0U)
+                std::memcpy(data, m_data, m_size);
+
+            deallocate();
+
+            m_data     = data;
+            m_capacity = capacity;
+        }
+
+        void deallocate() {
+            if (m_data && !is_inline())
+                m_resource->deallocate(m_data, m_capacity, alignment);
+
+            m_data     = inline_data();
+            m_capacity = inline_capacity;
+        }
+
+        value_type* inline_data() {
+            if constexpr (inline_capacity != 0U)
+                return m_inline.data();
+            else
+                return nullptr;
+        }
+
+        /*
+            Take other's bytes, copying them if they are inline. Storage must be inline.
+        */
+        void take(byte_vector& other) noexcept {
+            if (other.is_inline()) {
+                std::memcpy(inline_data(), other.m_data, other.m_size);
+
+                m_data     = inline_data();
+                m_capacity = inline_capacity;
+            }
+            else {
+                m_data     = std::exchange(other.m_data, other.inline_data());
+                m_capacity = std::exchange(other.m_capacity, inline_capacity);
+            }
+
+            m_size       = other.m_size;
+            other.m_size = 0U;
+        }
+    };
+}
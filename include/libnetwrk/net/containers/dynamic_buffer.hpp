@@ -1,47 +1,96 @@
 #pragma once
 
 #include "libnetwrk/net/containers/buffer.hpp"
+#include "libnetwrk/net/containers/byte_vector.hpp"
 
-#include <vector>
+#include <algorithm>
+#include <memory_resource>
+#include <utility>
 
 namespace libnetwrk::serialize {
-    template<typename Buffer, typename Type>
+    template<is_buffer Buffer, typename Type>
     void serialize(Buffer& buffer, const Type& value);
 
-    template<typename Buffer, typename Type>
+    template<is_buffer Buffer, typename Type>
     void deserialize(Buffer& buffer, Type& obj);
+
+    template<is_buffer Buffer, typename Type>
+    deserialize_error try_deserialize(Buffer& buffer, Type& obj);
+
+    template<typename Type>
+    constexpr size_t serialized_size(const Type& value);
 }
 
-namespace libnetwrk {
+namespace libnetwrk::inline LIBNETWRK_BUFFER_NAMESPACE {
     class dynamic_buffer : public buffer {
     public:
         using value_t        = buffer::value_t;
-        using container_t    = std::vector<value_t>;
+        using container_t    = byte_vector;
         using iterator       = container_t::iterator;
         using const_iterator = container_t::const_iterator;
 
     public:
-        dynamic_buffer()                      = default;
-        dynamic_buffer(const dynamic_buffer&) = default;
-        dynamic_buffer(dynamic_buffer&&)      = default;
+        dynamic_buffer() = default;
+
+        // Views alias the storage, they follow it on move and never to a copy.
+        // Copies use the default memory resource, moves keep the source's.
+        dynamic_buffer(const dynamic_buffer& other)
+            : buffer(other), m_container(other.m_container), m_limits(other.m_limits) {}
+
+        dynamic_buffer(dynamic_buffer&& other) noexcept
+            : buffer(std::move(other)), m_container(std::move(other.m_container)), m_limits(other.m_limits)
+        {
+            take_views(other);
+        }
 
         dynamic_buffer(uint32_t size) {
             m_container.resize((size_t)size);
         }
 
-        dynamic_buffer& operator=(const dynamic_buffer&) = default;
-        dynamic_buffer& operator=(dynamic_buffer&&)      = default;
+        /*
+            Allocate from resource, like a per tick arena. The resource must outlive the buffer.
+        */
+        explicit dynamic_buffer(std::pmr::memory_resource* resource)
+            : m_container(resource) {}
+
+        ~dynamic_buffer() {
+            poison_views();
+        }
+
+        dynamic_buffer& operator=(const dynamic_buffer& other) {
+            if (this == &other) return *this;
+
+            poison_views();
+            buffer::operator=(other);
+            m_container = other.m_container;
+            m_limits    = other.m_limits;
+            return *this;
+        }
+
+        dynamic_buffer& operator=(dynamic_buffer&& other) noexcept {
+            if (this == &other) return *this;
+
+            poison_views();
+            buffer::operator=(std::move(other));
+            m_container = std::move(other.m_container);
+            m_limits    = other.m_limits;
+
+            take_views(other);
+            return *this;
+        }
 
     public:
-        value_t* data() override {
+        value_t* data() {
             return m_container.data();
         }
 
-        uint32_t size() override {
+        uint32_t size() {
             return (uint32_t)m_container.size();
         }
 
-        void clear() override {
+        void clear() {
+            poison_views();
+
             m_read_index = 0;
             m_container.clear();
         }
@@ -70,6 +119,39 @@ namespace libnetwrk {
             return m_container;
         }
 
+        std::pmr::memory_resource* get_memory_resource() const {
+            return m_container.get_memory_resource();
+        }
+
+        /*
+            Bound what deserializing from this buffer may allocate, like received messages are.
+        */
+        void set_deserialize_limits(const deserialize_limits& limits) {
+            m_limits = limits;
+        }
+
+        const deserialize_limits& get_deserialize_limits() const {
+            return m_limits;
+        }
+
+        /*
+            Make room for size more bytes. Grows at least geometrically,
+            so reserving before every write stays amortized.
+        */
+        void reserve_additional(size_t size) {
+            size_t required = m_container.size() + size;
+
+            if (required > m_container.capacity())
+                grow(std::max(required, m_container.capacity() * 2U));
+        }
+
+        /*
+            Views were taken into the buffer, see borrow().
+        */
+        friend bool& get_buffer_lent(dynamic_buffer& buffer) {
+            return buffer.m_lent;
+        }
+
         template<typename Value>
         dynamic_buffer& operator<<(const Value& value) {
             libnetwrk::serialize::serialize(*this, value);
@@ -83,6 +165,48 @@ namespace libnetwrk {
         }
 
     private:
-        container_t m_container;
+        container_t        m_container;
+        deserialize_limits m_limits;
+        bool               m_lent = false;
+
+    private:
+        /*
+            With LIBNETWRK_POISON_VIEWS defined, the data views alias is overwritten before it
+            goes away or moves, so views that outlive it read garbage instead of stale data.
+            Clearing, destroying, assigning, moving and growing through writes are covered,
+            writes into underlying() directly are not.
+        */
+        void poison_views() {
+        #ifdef LIBNETWRK_POISON_VIEWS
+            if (m_lent)
+                std::fill(m_container.begin(), m_container.end(), static_cast<value_t>(0xDD));
+        #endif
+
+            m_lent = false;
+        }
+
+        /*
+            Views are only taken from allocated storage, which moves along.
+        */
+        void take_views(dynamic_buffer& other) {
+            m_lent = std::exchange(other.m_lent, false);
+        }
+
+        void grow(size_t capacity) {
+        #ifdef LIBNETWRK_POISON_VIEWS
+            // Copy out of the storage views alias, so they read poison instead of following the data
+            if (m_lent) {
+                container_t grown(m_container.get_memory_resource());
+                grown.reserve(capacity);
+                grown.assign(m_container.data(), m_container.size());
+
+                poison_views();
+                m_container.swap(grown);
+                return;
+            }
+        #endif
+
+            m_container.reserve(capacity);
+        }
     };
 }
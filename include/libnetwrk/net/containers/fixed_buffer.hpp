@@ -5,10 +5,10 @@
 #include <array>
 
 namespace libnetwrk::serialize {
-    template<typename Buffer, typename Type>
+    template<is_buffer Buffer, typename Type>
     void serialize(Buffer& buffer, const Type& value);
 
-    template<typename Buffer, typename Type>
+    template<is_buffer Buffer, typename Type>
     void deserialize(Buffer& buffer, Type& obj);
 }
 
@@ -33,15 +33,15 @@ namespace libnetwrk {
         fixed_buffer_t& operator=(fixed_buffer_t&&)      = default;
 
     public:
-        value_t* data() override {
+        value_t* data() {
             return m_container.data();
         }
 
-        uint32_t size() override {
+        uint32_t size() {
             return (uint32_t)m_container.size();
         }
 
-        void clear() override {
+        void clear() {
             m_read_index = 0;
             m_write_index = 0;
         }
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+namespace libnetwrk {
+    /*
+        Unbounded lock-free multi producer, single consumer queue.
+
+        Linked list with a dummy head node (Vyukov). Any thread may push, producers
+        never block or retry. Only one thread at a time may pop or clear.
+        The first dummy is embedded, so a queue that was never pushed to allocates nothing.
+        After a pop the popped node becomes the dummy, so an emptied queue keeps one node
+        allocated until the next pop or its destruction.
+    */
+    template<typename Value>
+    class mpsc_queue {
+    public:
+        using value_t = Value;
+
+    public:
+        mpsc_queue()
+            : m_head(&m_stub), m_tail(&m_stub) {}
+
+        mpsc_queue(const mpsc_queue&) = delete;
+        mpsc_queue(mpsc_queue&&)      = delete;
+
+        ~mpsc_queue() {
+            clear();
+
+            if (m_tail != &m_stub)
+                delete m_tail;
+        }
+
+        mpsc_queue& operator=(const mpsc_queue&) = delete;
+        mpsc_queue& operator=(mpsc_queue&&)      = delete;
+
+    public:
+        /*
+            Approximate number of queued values, safe from any thread.
+            A value is counted once its push completes.
+        */
+        size_t size() const {
+            std::ptrdiff_t size = m_size.load(std::memory_order_acquire);
+            return size > 0 ? static_cast<size_t>(size) : 0U;
+        }
+
+        bool empty() const {
+            return size() == 0U;
+        }
+
+        void push(value_t value) {
+            node* pushed = new node();
+            pushed->value = std::move(value);
+
+            node* previous = m_head.exchange(pushed, std::memory_order_acq_rel);
+            previous->next.store(pushed, std::memory_order_release);
+
+            // Counted after linking, so a consumer seeing a count never spins on a half linked push.
+            // It can briefly go negative when the consumer pops first.
+            m_size.fetch_add(1, std::memory_order_release);
+        }
+
+        /*
+            Take the oldest value. Consumer only.
+            May miss a producer that is half way through a push, its notify follows.
+        */
+        bool try_pop(value_t& value) {
+            node* tail = m_tail;
+            node* next = tail->next.load(std::memory_order_acquire);
+
+            if (!next)
+                return false;
+
+            value  = std::move(next->value);
+            m_tail = next;
+
+            if (tail != &m_stub)
+                delete tail;
+
+            m_size.fetch_sub(1, std::memory_order_release);
+            return true;
+        }
+
+        /*
+            Drop all values. Consumer only.
+        */
+        void clear() {
+            value_t value;
+
+            while (try_pop(value))
+                value = value_t();
+        }
+
+    private:
+        struct node {
+            std::atomic<node*> next = nullptr;
+            value_t            value{};
+        };
+
+    private:
+        std::atomic<node*>          m_head;
+        node*                       m_tail;
+        std::atomic<std::ptrdiff_t> m_size = 0;
+        node                        m_stub;
+    };
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <utility>
+
+namespace libnetwrk {
+    /*
+        Container with O(1) insert, lookup and erase through generation-tagged keys.
+
+        Values are stored densely for iteration, erasing moves the last value into the
+        erased spot. Keys hold the slot index + 1 in the low 32 bits and the slot
+        generation in the high 32 bits, so a key of an erased value never matches the
+        value that reuses its slot. Key 0 is never handed out.
+    */
+    template<typename Value>
+    class slot_map {
+    public:
+        using key_t          = uint64_t;
+        using value_t        = Value;
+        using container_t    = std::vector<value_t>;
+        using iterator       = container_t::iterator;
+        using const_iterator = container_t::const_iterator;
+
+    public:
+        slot_map()                = default;
+        slot_map(const slot_map&) = default;
+        slot_map(slot_map&&)      = default;
+
+        slot_map& operator=(const slot_map&) = default;
+        slot_map& operator=(slot_map&&)      = default;
+
+    public:
+        key_t insert(value_t value) {
+            uint32_t slot_index = 0U;
+
+            if (m_free_head != npos) {
+                slot_index  = m_free_head;
+                m_free_head = m_slots[slot_index].index;
+            }
+            else {
+                slot_index = static_cast<uint32_t>(m_slots.size());
+                m_slots.push_back({});
+            }
+
+            m_slots[slot_index].index = static_cast<uint32_t>(m_values.size());
+            m_values.push_back(std::move(value));
+            m_dense_to_slot.push_back(slot_index);
+
+            return make_key(slot_index, m_slots[slot_index].generation);
+        }
+
+        /*
+            Get value by key. Returns nullptr if key is stale or invalid.
+        */
+        value_t* find(key_t key) {
+            uint32_t slot_index = 0U;
+            if (!get_slot_index(key, slot_index))
+                return nullptr;
+
+            return &m_values[m_slots[slot_index].index];
+        }
+
+        bool contains(key_t key) const {
+            uint32_t slot_index = 0U;
+            return get_slot_index(key, slot_index);
+        }
+
+        bool erase(key_t key) {
+            uint32_t slot_index = 0U;
+            if (!get_slot_index(key, slot_index))
+                return false;
+
+            erase_dense(m_slots[slot_index].index);
+            return true;
+        }
+
+        template<typename Predicate>
+        size_t remove_if(Predicate predicate) {
+            size_t removed = 0U;
+
+            for (uint32_t i = 0U; i < m_values.size();) {
+                if (predicate(m_values[i])) {
+                    erase_dense(i);
+                    removed++;
+                }
+                else {
+                    i++;
+                }
+            }
+
+            return removed;
+        }
+
+        void clear() {
+            for (uint32_t i = static_cast<uint32_t>(m_values.size()); i > 0U; i--)
+                erase_dense(i - 1);
+        }
+
+        size_t size() const {
+            return m_values.size();
+        }
+
+        bool empty() const {
+            return m_values.empty();
+        }
+
+        iterator begin() {
+            return m_values.begin();
+        }
+
+        const_iterator begin() const {
+            return m_values.begin();
+        }
+
+        iterator end() {
+            return m_values.end();
+        }
+
+        const_iterator end() const {
+            return m_values.end();
+        }
+
+    private:
+        struct slot_t {
+            uint32_t generation = 0U;
+            uint32_t index      = 0U;     // Index into values when used, next free slot otherwise
+        };
+
+        static constexpr uint32_t npos = static_cast<uint32_t>(-1);
+
+    private:
+        std::vector<slot_t>   m_slots;
+        container_t           m_values;
+        std::vector<uint32_t> m_dense_to_slot;
+        uint32_t              m_free_head = npos;
+
+    private:
+        static key_t make_key(uint32_t slot_index, uint32_t generation) {
+            return (static_cast<key_t>(generation) << 32) | (static_cast<key_t>(slot_index) + 1U);
+        }
+
+        bool get_slot_index(key_t key, uint32_t& out_slot_index) const {
+            uint32_t low = static_cast<uint32_t>(key);
+            if (low == 0U || low > m_slots.size())
+                return false;
+
+            const slot_t& slot = m_slots[low - 1U];
+            if (slot.generation != static_cast<uint32_t>(key >> 32))
+                return false;
+
+            // Free slot
+            if (slot.index >= m_dense_to_slot.size() || m_dense_to_slot[slot.index] != low - 1U)
+                return false;
+
+            out_slot_index = low - 1U;
+            return true;
+        }
+
+        void erase_dense(uint32_t dense_index) {
+            uint32_t slot_index = m_dense_to_slot[dense_index];
+            uint32_t last_index = static_cast<uint32_t>(m_values.size() - 1);
+
+            if (dense_index != last_index) {
+                m_values[dense_index]        = std::move(m_values[last_index]);
+                m_dense_to_slot[dense_index] = m_dense_to_slot[last_index];
+
+                m_slots[m_dense_to_slot[dense_index]].index = dense_index;
+            }
+
+            m_values.pop_back();
+            m_dense_to_slot.pop_back();
+
+            m_slots[slot_index].generation++;
+            m_slots[slot_index].index = m_free_head;
+            m_free_head               = slot_index;
+        }
+    };
+}
@@ -5,9 +5,13 @@
 #include "libnetwrk/net/core/client/client_comp_message.hpp"
 #include "libnetwrk/net/core/client/client_comp_system_message.hpp"
 #include "libnetwrk/net/core/client/client_connection_internal.hpp"
+#include "libnetwrk/exceptions/libnetwrk_exception.hpp"
 
 #include <string>
 #include <cstdint>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 namespace libnetwrk {
     template<typename Desc, typename Socket>
@@ -36,10 +40,9 @@ namespace libnetwrk {
             m_context.name = name;
 
             m_context.cb_internal_disconnect = [this](auto) {
-                std::thread t = std::thread([this] {
+                run_detached([this] {
                     this->internal_disconnect(false);
                 });
-                t.detach();
             };
         }
 
@@ -53,26 +56,37 @@ namespace libnetwrk {
 
         /*
             Connect to service.
+
+            Blocks until the io thread finishes connecting, so it can't be called from it.
+            Use async_connect or co_connect from io thread callbacks and coroutines.
         */
         bool connect(const std::string& host, const uint16_t port) {
-            if (m_context.status != to_underlying(service_status::stopped))
-                return false;
-
-            m_context.status = to_underlying(service_status::starting);
+            if (m_context.io_context.get_executor().running_in_this_thread())
+                throw libnetwrk_exception("client: connect() would block the io thread.");
 
-            bool connected = connect_impl(host, port);
+            return async_connect(host, port, asio::use_future).get();
+        }
 
-            if (connected) {
-                if (m_context.cb_connect)
-                    m_context.cb_connect(m_comp_connection.connection);
+        /*
+            Connect to service without blocking.
 
-                m_context.status = to_underlying(service_status::started);
-            }
-            else {
-                m_context.status = to_underlying(service_status::stopped);
-            }
+            @param void(bool) token -> completion handler or token, true if connected
+        */
+        template<typename CompletionToken>
+        auto async_connect(const std::string& host, const uint16_t port, CompletionToken&& token) {
+            return asio::async_initiate<CompletionToken, void(bool)>(
+                [this](auto handler, const std::string& host, const uint16_t port) {
+                    initiate_connect(host, port, std::move(handler));
+                },
+                token, host, port
+            );
+        }
 
-            return connected;
+        /*
+            Connect to service from a coroutine.
+        */
+        asio::awaitable<bool> co_connect(std::string host, uint16_t port) {
+            co_return co_await async_connect(host, port, asio::use_awaitable);
         }
 
         /*
@@ -173,8 +187,11 @@ namespace libnetwrk {
 
     protected:
         virtual void teardown() {
-            m_context.cancel_cv.notify_all();
-            m_context.cancel_cv.wait_for_end();
+            // Disconnect detected on the io thread and destruction can tear down at the same time
+            std::lock_guard<std::mutex> guard(m_teardown_mutex);
+
+            m_context.cancel_event.close();
+            m_context.cancel_event.wait_for_end();
 
             m_comp_connection.stop_connection();
 
@@ -184,11 +201,87 @@ namespace libnetwrk {
             m_comp_message.stop_processing_messages();
         }
 
-        virtual bool connect_impl(const std::string& host, const uint16_t port) {
-            return false;
+        virtual asio::awaitable<bool> connect_impl(std::string host, uint16_t port) {
+            co_return false;
+        }
+
+        /*
+            Wait for detached teardowns to finish, so they don't outlive the client.
+        */
+        void wait_for_detached() {
+            std::unique_lock<std::mutex> lock(m_detached_mutex);
+
+            m_detached_cv.wait(lock, [this] {
+                return m_detached_operations == 0U;
+            });
         }
 
     private:
+        std::mutex              m_teardown_mutex;
+        std::condition_variable m_detached_cv;
+        std::mutex              m_detached_mutex;
+        uint32_t                m_detached_operations = 0U;
+
+    private:
+        /*
+            Run on a detached thread. Teardown joins the io_context thread so it can't run on it.
+        */
+        template<typename Func>
+        void run_detached(Func&& func) {
+            {
+                std::lock_guard<std::mutex> guard(m_detached_mutex);
+                m_detached_operations++;
+            }
+
+            std::thread t = std::thread([this, func = std::forward<Func>(func)]() mutable {
+                func();
+
+                // Notify under the lock, the waiter may destroy the client as soon as it can take it
+                std::lock_guard<std::mutex> guard(m_detached_mutex);
+                m_detached_operations--;
+                m_detached_cv.notify_all();
+            });
+            t.detach();
+        }
+
+        template<typename Handler>
+        void initiate_connect(const std::string& host, const uint16_t port, Handler handler) {
+            auto executor = asio::get_associated_executor(handler, asio::system_executor());
+
+            auto complete = [executor](Handler handler, bool connected) {
+                asio::dispatch(executor, [handler = std::move(handler), connected]() mutable {
+                    std::move(handler)(connected);
+                });
+            };
+
+            if (m_context.status != to_underlying(service_status::stopped))
+                return complete(std::move(handler), false);
+
+            m_context.status = to_underlying(service_status::starting);
+
+            asio::co_spawn(m_context.io_context, connect_impl(host, port),
+                [this, complete, handler = std::move(handler)](std::exception_ptr, bool connected) mutable {
+                    if (connected) {
+                        m_comp_system_message.start_authentication(m_comp_connection.connection);
+
+                        if (m_context.cb_connect)
+                            m_context.cb_connect(m_comp_connection.connection);
+
+                        m_context.status = to_underlying(service_status::started);
+                        return complete(std::move(handler), true);
+                    }
+
+                    run_detached([this, complete, handler = std::move(handler)]() mutable {
+                        this->teardown();
+                        m_context.status = to_underlying(service_status::stopped);
+                        complete(std::move(handler), false);
+                    });
+                }
+            );
+
+            m_context.start_io_context();
+        }
+
         virtual void internal_disconnect(bool user_initiated) {
             if (m_context.status != to_underlying(service_status::started))
                 return;
@@ -2,7 +2,10 @@
 
 #include "libnetwrk/net/core/client/client_connection_internal.hpp"
 
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 
 namespace libnetwrk {
     template<typename Context>
@@ -11,6 +14,7 @@ namespace libnetwrk {
         using context_t          = Context;
         using connection_t       = typename Context::connection_internal_t;
         using endpoint_t         = typename Context::endpoint_t;
+        using native_socket_t    = connection_t::native_socket_t;
         using message_t          = connection_t::message_t;
         using owned_message_t    = connection_t::owned_message_t;
         using outgoing_message_t = connection_t::outgoing_message_t;
@@ -20,28 +24,50 @@ namespace libnetwrk {
 
     public:
         client_comp_connection(context_t& context)
-            : m_context(context) {}
+            : m_context(context)
+        {
+            m_context.cb_internal_closed = [this](auto) {
+                // Taking the mutex orders the notify after the waiter's check
+                { std::lock_guard<std::mutex> guard(m_closed_mutex); }
+                m_closed_cv.notify_all();
+            };
+        }
 
     public:
         void create_connection() {
             connection = std::make_shared<connection_t>(m_context.io_context);
         }
 
-        void establish_connection(const endpoint_t& endpoint) {
+        void establish_connection(native_socket_t&& socket) {
             if (connection)
-                connection->connect(endpoint);
+                connection->connect(std::move(socket));
         }
 
         void stop_connection() {
             if (connection) {
                 connection->stop();
 
-                if (connection->cancel_cv.has_active_operations())
-                    connection->cancel_cv.wait_for_end();
+                wait_for_closed();
             }
         }
 
     private:
-        context_t& m_context;
+        context_t&              m_context;
+        std::condition_variable m_closed_cv;
+        std::mutex              m_closed_mutex;
+
+    private:
+        /*
+            Block until read and write finished on the io thread or the io context stopped.
+        */
+        void wait_for_closed() {
+            // A stopped io context doesn't wake anyone, check on it every so often
+            constexpr auto stopped_check_interval = std::chrono::milliseconds(100);
+
+            std::unique_lock<std::mutex> lock(m_closed_mutex);
+
+            while (connection->has_active_operations() && !m_context.io_context.stopped())
+                m_closed_cv.wait_for(lock, stopped_check_interval);
+        }
     };
 }
\ No newline at end of file
@@ -4,12 +4,14 @@
 #include "asio/experimental/awaitable_operators.hpp"
 #include "libnetwrk/net/misc/authentication.hpp"
 #include "libnetwrk/net/core/client/client_comp_message.hpp"
-#include "libnetwrk/net/misc/coroutine_cv.hpp"
+#include "libnetwrk/net/core/shared/shared_comp_system_message.hpp"
+#include "libnetwrk/net/misc/async_event.hpp"
 
 namespace libnetwrk {
     template<typename Context>
-    class client_comp_system_message {
+    class client_comp_system_message : public shared_comp_system_message<Context> {
     public:
+        using base_t                = shared_comp_system_message<Context>;
         using context_t             = Context;
         using comp_message_t        = client_comp_message<Context>;
         using connection_internal_t = context_t::connection_internal_t;
@@ -35,21 +37,78 @@ namespace libnetwrk {
             m_comp_message.send(message, libnetwrk::send_flags::none);
         }
 
+        /*
+            Called once connected. Trusted connections skip the challenge.
+        */
+        void start_authentication(std::shared_ptr<connection_internal_t> connection) {
+            if (m_context.settings.auth == auth_mode::trusted)
+                authenticated(connection);
+        }
+
     private:
         context_t&      m_context;
         comp_message_t& m_comp_message;
 
-    private:
-
     private:
         void start_clock_syncing() {
             using namespace asio::experimental::awaitable_operators;
 
-            asio::co_spawn(m_context.io_context, co_clock_sync() || m_context.cancel_cv.wait(), [this](auto, auto) {
+            asio::co_spawn(m_context.io_context, co_clock_sync() || m_context.cancel_event.wait(), [this](auto, auto) {
                 LIBNETWRK_DEBUG(m_context.name, "Stopped clock syncing.");
             });
         }
 
+        void start_heartbeats(std::shared_ptr<connection_internal_t> connection) {
+            using namespace asio::experimental::awaitable_operators;
+
+            if (m_context.settings.heartbeat_interval_sec == 0U)
+                return;
+
+            asio::co_spawn(m_context.io_context, co_heartbeat(connection) || m_context.cancel_event.wait(), [this](auto, auto) {
+                LIBNETWRK_DEBUG(m_context.name, "Stopped heartbeats.");
+            });
+        }
+
+        /*
+            Heartbeat the service after an interval without receiving anything.
+            Any received message counts as an answer so busy connections never send heartbeats.
+        */
+        asio::awaitable<void> co_heartbeat(std::shared_ptr<connection_internal_t> connection) {
+            uint64_t interval_ms = m_context.settings.heartbeat_interval_sec * 1000ULL;
+            uint64_t max_idle_ms = interval_ms * (m_context.settings.heartbeat_max_missed + 1ULL);
+            uint64_t next_ms     = interval_ms;
+
+            asio::steady_timer timer(m_context.io_context);
+
+            while (true) {
+                timer.expires_after(std::chrono::milliseconds(next_ms));
+
+                auto [ec] = co_await timer.async_wait(asio::as_tuple(asio::use_awaitable));
+                if (ec || !connection->is_connected()) break;
+
+                uint64_t now           = get_steady_milliseconds_timestamp();
+                uint64_t last_received = connection->last_receive_timestamp;
+                uint64_t idle          = now > last_received ? now - last_received : 0U;
+
+                if (idle >= max_idle_ms) {
+                    LIBNETWRK_WARNING(m_context.name, "Heartbeat timeout.");
+
+                    if (m_context.cb_internal_disconnect)
+                        m_context.cb_internal_disconnect(connection);
+
+                    break;
+                }
+
+                if (idle < interval_ms) {
+                    next_ms = interval_ms - idle;
+                    continue;
+                }
+
+                base_t::send_heartbeat(*connection);
+                next_ms = interval_ms;
+            }
+        }
+
         asio::awaitable<void> co_clock_sync() {
             asio::steady_timer timer(m_context.io_context, std::chrono::seconds(m_context.settings.clock_sync_freq_sec));
 
@@ -69,16 +128,56 @@ namespace libnetwrk {
                 case system_command::s2c_verify:     return on_system_verify_message(message);
                 case system_command::s2c_verify_ok:  return on_system_verify_ok_message(message);
                 case system_command::sev_clock_sync: return on_system_clock_sync_message(message);
+                case system_command::heartbeat:      return this->on_system_heartbeat_message(message);
+                case system_command::heartbeat_ack:  return on_system_heartbeat_ack_message(message);
                 
-                default: return;
+                default: return protocol_violation(message);
             }
         }
 
+        /*
+            Disconnect from a service that sent an unknown or unsolicited system message.
+        */
+        void protocol_violation(owned_message_t* message) {
+            auto connection = std::static_pointer_cast<connection_internal_t>(message->sender);
+
+            LIBNETWRK_ERROR(m_context.name, "Received an unexpected system message.");
+
+            connection->disconnect_code = libnetwrk::disconnect_code::protocol_violation;
+
+            if (m_context.cb_internal_disconnect)
+                m_context.cb_internal_disconnect(connection);
+        }
+
+        void on_system_heartbeat_ack_message(owned_message_t* message) {
+            if (m_context.settings.heartbeat_interval_sec == 0U)
+                return protocol_violation(message);
+
+            base_t::on_system_heartbeat_ack_message(message);
+        }
+
         void on_system_verify_message(owned_message_t* message) {
+            auto connection = std::static_pointer_cast<connection_internal_t>(message->sender);
+
+            // A trusted client already released its messages, the service would drop them all
+            if (m_context.settings.auth == auth_mode::trusted) {
+                LIBNETWRK_ERROR(m_context.name, "Service sent a challenge to a trusted client, auth modes don't match.");
+
+                if (m_context.cb_internal_disconnect)
+                    m_context.cb_internal_disconnect(connection);
+
+                return;
+            }
+
             authentication::request_t  auth_request{};
             authentication::response_t auth_response{};
 
-            message->message >> auth_request;
+            if (message->message.try_read(auth_request) != deserialize_error::none) {
+                if (m_context.cb_internal_disconnect)
+                    m_context.cb_internal_disconnect(connection);
+
+                return;
+            }
             auth_response = authentication::generate_response(auth_request);
 
             message_t response{};
@@ -86,15 +185,25 @@ namespace libnetwrk {
             response.head.command = static_cast<uint64_t>(system_command::c2s_verify);
             response << auth_response;
 
-            message->sender->send(response);
+            connection->send(response);
+
+            // Queued behind the response, the service holds them until verified
+            if (m_context.settings.auth == auth_mode::optimistic)
+                connection->release_user_messages();
         }
 
         void on_system_verify_ok_message(owned_message_t* msg) {
-            auto connection = std::static_pointer_cast<connection_internal_t>(msg->sender);
-            connection->is_authenticated = true;
-            connection->write_cv.notify_all();
+            authenticated(std::static_pointer_cast<connection_internal_t>(msg->sender));
+        }
+
+        void authenticated(std::shared_ptr<connection_internal_t> connection) {
+            if (connection->is_authenticated.exchange(true))
+                return;
+
+            connection->release_user_messages();
 
             start_clock_syncing();
+            start_heartbeats(connection);
         }
 
         void on_system_clock_sync_message(owned_message_t* message) {
@@ -103,7 +212,10 @@ namespace libnetwrk {
             uint64_t service_timestamp = 0U;
             uint64_t current_timestamp = get_milliseconds_timestamp();
 
-            message->message >> sample_index >> client_timestamp >> service_timestamp;
+            if (message->message.try_read(sample_index)      != deserialize_error::none ||
+                message->message.try_read(client_timestamp)  != deserialize_error::none ||
+                message->message.try_read(service_timestamp) != deserialize_error::none)
+                return;
 
             if (sample_index < m_context.clock_drift_samples.size()) {
                 /*
@@ -156,4 +268,4 @@ namespace libnetwrk {
             LIBNETWRK_DEBUG(m_context.name, "Clock synced.");
         }
     };
-}
+}
\ No newline at end of file
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "libnetwrk/net/core/client/client_connection.hpp"
-#include "libnetwrk/net/misc/coroutine_cv.hpp"
+#include "libnetwrk/net/misc/async_event.hpp"
 #include "libnetwrk/net/enum/enums.hpp"
 
 #include <memory>
@@ -19,6 +19,7 @@ namespace libnetwrk {
         using command_t          = base_t::command_t;
         using connection_t       = client_connection_internal<Desc, Socket>;
         using endpoint_t         = typename Socket::endpoint_t;
+        using native_socket_t    = typename Socket::native_socket_t;
         using message_t          = base_t::message_t;
         using owned_message_t    = base_t::owned_message_t;
         using outgoing_message_t = base_t::outgoing_message_t;
@@ -29,48 +30,101 @@ namespace libnetwrk {
         client_connection_internal(connection_t&&)      = default;
 
         client_connection_internal(io_context_t& context)
-            : base_t(context), write_cv(context), cancel_cv(context)
+            : base_t(context), write_event(context), stop_event(context)
         {
-            is_authenticated  = false;
+            is_authenticated       = false;
+            disconnect_code        = libnetwrk::disconnect_code::unspecified;
+            last_receive_timestamp = get_steady_milliseconds_timestamp();
+            last_send_timestamp    = last_receive_timestamp.load();
         }
 
         connection_t& operator=(const connection_t&) = delete;
         connection_t& operator=(connection_t&&)      = default;
 
     public:
-        std::atomic_bool is_authenticated;
+        // Wakes the writer for new messages, closed on stop
+        async_event write_event;
 
-        coroutine_cv write_cv;
-        coroutine_cv cancel_cv;
+        // Closed on stop, interrupts the reader's rate limit delay
+        async_event stop_event;
+
+        // Steady ms timestamps of the last complete read and write
+        std::atomic_uint64_t last_receive_timestamp;
+        std::atomic_uint64_t last_send_timestamp;
+
+        libnetwrk::disconnect_code disconnect_code;
+        std::atomic_bool           is_authenticated;
+
+        // User messages are held back until released, when depends on the auth mode
+        std::atomic_bool is_sending_user_messages = false;
+
+        // Set while a message taken off the outgoing queues is being written
+        std::atomic_bool is_writing = false;
+
+        // Read and write coroutines still running
+        std::atomic_uint8_t active_operations = 0U;
 
     public:
         bool wait_for_messages() {
-            std::unique_lock<std::mutex> lock(this->m_outgoing_mutex);
-            return this->m_outgoing_system_messages.empty() || (this->m_outgoing_messages.empty() && this->is_authenticated);
+            return !has_system_messages() && !has_user_messages();
         }
 
         bool has_user_messages() {
-            return !this->m_outgoing_messages.empty() && this->is_authenticated;
+            return !this->m_outgoing_messages.empty() && this->is_sending_user_messages;
         }
 
         bool has_system_messages() {
             return !this->m_outgoing_system_messages.empty();
         }
 
-        std::queue<std::shared_ptr<outgoing_message_t>>& get_user_messages()   { return this->m_outgoing_messages; }
-        std::queue<std::shared_ptr<outgoing_message_t>>& get_system_messages() { return this->m_outgoing_system_messages; }
-        std::mutex&                                      get_outgoing_mutex()  { return this->m_outgoing_mutex; }
+        bool has_active_operations() {
+            return active_operations != 0U;
+        }
+
+        /*
+            Take the next message to write, system messages first.
+            User messages are held back until released. Writer only.
+        */
+        std::shared_ptr<outgoing_message_t> pop_outgoing_message() {
+            std::shared_ptr<outgoing_message_t> message;
+            is_writing = true;
+
+            if (!this->m_outgoing_system_messages.try_pop(message) && this->is_sending_user_messages)
+                this->m_outgoing_messages.try_pop(message);
+
+            is_writing = message != nullptr;
+            return message;
+        }
+
+        /*
+            Let held back user messages go out after any system message already queued.
+        */
+        void release_user_messages() {
+            is_sending_user_messages = true;
+            write_event.notify_one();
+        }
 
     public:
         void stop() override final {
             base_t::stop();
-            write_cv.notify_all();
-            cancel_cv.notify_all();
+            write_event.close();
+            stop_event.close();
         }
 
     public:
-        void connect(const endpoint_t& endpoint) {
-            this->m_socket.connect(endpoint);
+        /*
+            Take ownership of an already connected socket.
+        */
+        void connect(native_socket_t&& socket) {
+            this->m_socket = Socket(std::move(socket));
+        }
+
+        void add_rtt_sample(uint64_t sample_us) {
+            this->update_rtt(sample_us);
+        }
+
+        void add_rate_limit_violation() {
+            this->m_rate_limit_violations++;
         }
 
         asio::awaitable<void> co_read_message(message_t& recv_message, std::error_code& ec) {
@@ -83,7 +137,7 @@ namespace libnetwrk {
 
     protected:
         void notify() override final {
-            write_cv.notify_one();
+            write_event.notify_one();
         }
     };
 }
@@ -6,7 +6,16 @@
 
 namespace libnetwrk {
     struct client_settings {
-        uint16_t clock_sync_freq_sec = 120U;
+        uint16_t clock_sync_freq_sec      = 120U;
+        uint32_t connect_timeout_ms       = 10000U;   // Covers resolving the host and connecting
+        uint16_t connect_attempt_delay_ms = 250U;     // Delay between parallel attempts to multiple endpoints
+        uint16_t heartbeat_interval_sec   = 0U;       // Heartbeat after this long without receiving, 0 to disable
+        uint8_t  heartbeat_max_missed     = 3U;       // Disconnect after this many unanswered heartbeats
+
+        inbound_rate_limit inbound_limit;
+        deserialize_limits decode_limits = { .max_allocation_ratio = 64U };     // Applied to each received message
+        auth_mode          auth          = auth_mode::challenge;
+        bool               compact       = false;                               // Read received user messages as compact, the service sends them compact
     };
 
     template<typename Connection>
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "libnetwrk/exceptions/libnetwrk_exception.hpp"
 #include "libnetwrk/net/core/service/service_context.hpp"
 #include "libnetwrk/net/core/service/service_comp_connection.hpp"
 #include "libnetwrk/net/core/service/service_comp_message.hpp"
@@ -40,6 +41,21 @@ namespace libnetwrk {
                 if (connection->disconnect_code == libnetwrk::disconnect_code::authentication_failed) {
                     LIBNETWRK_VERBOSE(m_context.name, "[{}] Auth timeout. Disconnecting client.", connection->get_id());
                 }
+                else if (connection->disconnect_code == libnetwrk::disconnect_code::idle_timeout) {
+                    LIBNETWRK_VERBOSE(m_context.name, "[{}] Idle timeout. Disconnecting client.", connection->get_id());
+                }
+                else if (connection->disconnect_code == libnetwrk::disconnect_code::read_timeout) {
+                    LIBNETWRK_VERBOSE(m_context.name, "[{}] Read timeout. Disconnecting client.", connection->get_id());
+                }
+                else if (connection->disconnect_code == libnetwrk::disconnect_code::heartbeat_timeout) {
+                    LIBNETWRK_VERBOSE(m_context.name, "[{}] Heartbeat timeout. Disconnecting client.", connection->get_id());
+                }
+                else if (connection->disconnect_code == libnetwrk::disconnect_code::rate_limited) {
+                    LIBNETWRK_VERBOSE(m_context.name, "[{}] Rate limited. Disconnecting client.", connection->get_id());
+                }
+                else if (connection->disconnect_code == libnetwrk::disconnect_code::protocol_violation) {
+                    LIBNETWRK_VERBOSE(m_context.name, "[{}] Protocol violation. Disconnecting client.", connection->get_id());
+                }
                 else {
                     LIBNETWRK_VERBOSE(m_context.name, "[{}] Client disconnected.", connection->get_id());
                 }
@@ -89,6 +105,43 @@ namespace libnetwrk {
                 m_context.cb_stop();
         }
 
+        /*
+            Stop accepting connections, wait for all outgoing messages to be sent, then stop.
+            Connections keep reading and processing while draining.
+            Once sent, connections are half closed and peers get the rest of the timeout to close,
+            closing with unread input resets the connection and drops data still in the socket buffer.
+
+            Blocks until drained, so it can't be called from the io thread.
+
+            @param timeout max time to wait for outgoing messages
+            @returns false if stopped with unsent messages left
+        */
+        bool drain(std::chrono::milliseconds timeout) {
+            if (m_context.io_context.get_executor().running_in_this_thread())
+                throw libnetwrk_exception("service: drain() would block the io thread.");
+
+            if (m_context.status != to_underlying(service_status::started))
+                return false;
+
+            LIBNETWRK_INFO(m_context.name, "Draining.");
+
+            this->stop_accepting();
+
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            bool flushed  = m_comp_connection.wait_for_flush(timeout);
+
+            if (!flushed) {
+                LIBNETWRK_WARNING(m_context.name, "Drain timed out with unsent messages.");
+            }
+            else {
+                auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+                m_comp_connection.wait_for_peer_close(remaining);
+            }
+
+            stop();
+            return flushed;
+        }
+
         void send(std::shared_ptr<connection_t> client, message_t& message, libnetwrk::send_flags flags = libnetwrk::send_flags::none) {
             m_comp_message.send(client, message, flags);
         }
@@ -120,6 +173,13 @@ namespace libnetwrk {
             return m_context.settings;
         }
 
+        /*
+            Get number of inbound messages over the rate limit across all connections.
+        */
+        uint64_t get_rate_limit_violations() const {
+            return m_context.rate_limit_violations;
+        }
+
         /*
             Set message callback
 
@@ -208,8 +268,8 @@ namespace libnetwrk {
 
     protected:
         virtual void teardown() { 
-            m_context.cancel_cv.notify_all();
-            m_context.cancel_cv.wait_for_end();
+            m_context.cancel_event.close();
+            m_context.cancel_event.wait_for_end();
 
             m_comp_connection.stop_connections();
 
@@ -221,6 +281,8 @@ namespace libnetwrk {
             return false;
         }
 
+        virtual void stop_accepting() {}
+
     protected:
         auto get_connection_by_id(uint64_t id) {
             return m_comp_connection.get_connection_by_id(id);
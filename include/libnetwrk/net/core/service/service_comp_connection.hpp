@@ -2,10 +2,23 @@
 
 #include "asio.hpp"
 #include "asio/experimental/awaitable_operators.hpp"
-#include "libnetwrk/net/misc/coroutine_cv.hpp"
+#include "libnetwrk/net/misc/async_event.hpp"
+#include "libnetwrk/net/misc/timer_wheel.hpp"
+#include "libnetwrk/net/misc/token_bucket.hpp"
+#include "libnetwrk/net/misc/timestamp.hpp"
+#include "libnetwrk/net/containers/slot_map.hpp"
+#include "libnetwrk/net/core/shared/shared_comp_system_message.hpp"
 
-#include <list>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <thread>
 #include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace libnetwrk {
     template<typename Context>
@@ -13,66 +26,557 @@ namespace libnetwrk {
     public:
         using context_t    = Context;
         using connection_t = typename Context::connection_internal_t;
+        using message_t    = typename Context::message_t;
 
     public:
-        std::list<std::shared_ptr<connection_t>> connections;
-        std::mutex                               connections_mutex;
+        slot_map<std::shared_ptr<connection_t>> connections;
+        std::shared_mutex                       connections_mutex;
 
     public:
         service_comp_connection(context_t& context)
-            : m_context(context) {}
+            : m_context(context)
+        {
+            m_context.cb_internal_closed = [this](auto connection) {
+                remove_connection(connection);
+                notify_waiters();
+            };
+
+            m_context.cb_internal_flushed = [this](auto) {
+                if (m_waiters != 0U)
+                    notify_waiters();
+            };
+        }
 
     public:
+        /*
+            Take the accept limits from settings. Called on start, later changes apply on the next start.
+        */
+        void start_admission() {
+            const auto& settings = m_context.settings;
+
+            std::lock_guard<std::mutex> guard(m_admission_mutex);
+
+            m_max_connections        = settings.max_connections;
+            m_max_connections_per_ip = settings.max_connections_per_ip;
+            m_accept_bucket.reset(settings.accept_rate_per_sec, settings.accept_burst);
+        }
+
+        /*
+            Check accept limits for a new connection from address and count it if admitted.
+            Admitted connections are released when removed or by release_admission().
+            The address is only converted to a string when a per ip limit is set.
+        */
+        template<typename Address>
+        bool try_admit(const Address& address) {
+            std::lock_guard<std::mutex> guard(m_admission_mutex);
+
+            if (m_max_connections && m_admitted >= m_max_connections)
+                return false;
+
+            std::string ip;
+
+            if (m_max_connections_per_ip) {
+                ip = address.to_string();
+
+                auto it = m_admitted_per_ip.find(ip);
+                if (it != m_admitted_per_ip.end() && it->second >= m_max_connections_per_ip)
+                    return false;
+            }
+
+            if (!m_accept_bucket.try_consume())
+                return false;
+
+            if (m_max_connections_per_ip)
+                m_admitted_per_ip[std::move(ip)]++;
+
+            m_admitted++;
+            return true;
+        }
+
+        void release_admission(connection_t& connection) {
+            if (!connection.is_admitted)
+                return;
+
+            std::lock_guard<std::mutex> guard(m_admission_mutex);
+
+            if (m_admitted)
+                m_admitted--;
+
+            if (!m_admitted_per_ip.empty()) {
+                auto it = m_admitted_per_ip.find(connection.get_ip());
+                if (it != m_admitted_per_ip.end() && --it->second == 0U)
+                    m_admitted_per_ip.erase(it);
+            }
+
+            connection.is_admitted = false;
+        }
+
+        /*
+            Get a connection from the pool or construct a new one.
+            The connection goes back to the pool once the last reference to it is dropped.
+            Without pooling, the connection and its control block share one allocation.
+        */
         std::shared_ptr<connection_t> create_connection() {
-            return std::make_shared<connection_t>(m_context.io_context);
+            std::unique_ptr<connection_t> connection;
+            bool                          pooled = true;
+
+            {
+                std::lock_guard<std::mutex> guard(m_pool->mutex);
+
+                m_pool->capacity = m_context.settings.connection_pool_size;
+                pooled           = m_pool->capacity != 0U;
+
+                if (!pooled) {
+                    m_pool->idle.clear();
+                }
+                else if (!m_pool->idle.empty()) {
+                    connection = std::move(m_pool->idle.back());
+                    m_pool->idle.pop_back();
+                }
+            }
+
+            if (!pooled)
+                return std::make_shared<connection_t>(m_context.io_context);
+
+            if (!connection)
+                connection = std::make_unique<connection_t>(m_context.io_context);
+
+            return std::shared_ptr<connection_t>(connection.release(),
+                [pool = std::weak_ptr<pool_t>(m_pool)](connection_t* released) {
+                    recycle(pool, released);
+                }
+            );
+        }
+
+        /*
+            Fill the pool up to connection_pool_warmup connections.
+        */
+        void warm_up_pool() {
+            std::lock_guard<std::mutex> guard(m_pool->mutex);
+
+            m_pool->capacity = m_context.settings.connection_pool_size;
+
+            size_t target = std::min(m_context.settings.connection_pool_warmup, m_context.settings.connection_pool_size);
+
+            while (m_pool->idle.size() < target)
+                m_pool->idle.push_back(std::make_unique<connection_t>(m_context.io_context));
         }
 
         void accept_connection(std::shared_ptr<connection_t> connection) {
-            std::lock_guard<std::mutex> guard(connections_mutex);
-            connection->set_id(m_id_count++);
-            connections.push_back(connection);
+            {
+                std::unique_lock<std::shared_mutex> guard(connections_mutex);
+                connection->set_id(connections.insert(connection));
+            }
+
+            schedule_deadlines(connection);
+        }
+
+        /*
+            Remove a closed connection and report the disconnect.
+            Returns false if the connection was already removed.
+        */
+        bool remove_connection(std::shared_ptr<connection_t> connection) {
+            {
+                std::unique_lock<std::shared_mutex> guard(connections_mutex);
+
+                if (!connections.erase(connection->get_id()))
+                    return false;
+            }
+
+            cancel_deadlines(*connection);
+            release_admission(*connection);
+
+            if (m_context.cb_disconnect)
+                m_context.cb_disconnect(connection, connection->disconnect_code);
+
+            return true;
         }
 
         void stop_connections() {
-            std::lock_guard guard(connections_mutex);
+            std::vector<std::shared_ptr<connection_t>> active;
 
-            for (auto& client : connections) {
+            // Don't hold the lock while waiting, closing connections remove themselves on the io thread
+            {
+                std::shared_lock<std::shared_mutex> guard(connections_mutex);
+                active.assign(connections.begin(), connections.end());
+            }
+
+            for (auto& client : active) {
                 if (!client) continue;
 
                 client->stop();
 
-                if (client->cancel_cv.has_active_operations())
-                    client->cancel_cv.wait_for_end();
+                // Read and write finish on the io thread
+                wait_until(std::chrono::steady_clock::time_point::max(), [&client] {
+                    return !client->has_active_operations();
+                });
             }
         }
 
-        std::shared_ptr<typename connection_t::base_t> get_connection_by_id(uint64_t id) {
-            std::lock_guard<std::mutex> guard(connections_mutex);
-            
-            for (auto& connection : connections) {
-                if (connection->get_id() == id)
-                    return connection;
+        /*
+            Wait until every open connection has written all of its outgoing messages.
+            Returns false if timeout expired or the io context stopped first.
+        */
+        bool wait_for_flush(std::chrono::milliseconds timeout) {
+            return wait_until(std::chrono::steady_clock::now() + timeout, [this] {
+                return !has_pending_writes();
+            });
+        }
+
+        /*
+            Half close every open connection and wait for the peers to close their side.
+            Returns false if timeout expired or the io context stopped first.
+        */
+        bool wait_for_peer_close(std::chrono::milliseconds timeout) {
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+
+            {
+                std::shared_lock<std::shared_mutex> guard(connections_mutex);
+
+                for (auto& client : connections) {
+                    if (!client) continue;
+
+                    // Socket is used by the io thread, shut down there
+                    asio::post(m_context.io_context, [client] {
+                        client->get_socket().shutdown_send();
+                    });
+                }
             }
 
-            return nullptr;
+            return wait_until(deadline, [this] {
+                std::shared_lock<std::shared_mutex> guard(connections_mutex);
+                return connections.empty();
+            });
+        }
+
+        /*
+            Get connection by id. Returns nullptr for ids of removed connections.
+        */
+        std::shared_ptr<typename connection_t::base_t> get_connection_by_id(uint64_t id) {
+            std::shared_lock<std::shared_mutex> guard(connections_mutex);
+
+            auto connection = connections.find(id);
+            return connection ? *connection : nullptr;
         }
 
         void start_gc() {
             using namespace asio::experimental::awaitable_operators;
 
-            asio::co_spawn(m_context.io_context, co_gc() || m_context.cancel_cv.wait(), [this](auto, auto) {
+            asio::co_spawn(m_context.io_context, co_gc() || m_context.cancel_event.wait(), [this](auto, auto) {
                 LIBNETWRK_VERBOSE(m_context.name, "Stopped GC.");
             });
         }
 
+        void start_timers() {
+            using namespace asio::experimental::awaitable_operators;
+
+            asio::co_spawn(m_context.io_context, co_timers() || m_context.cancel_event.wait(), [this](auto, auto) {
+                LIBNETWRK_VERBOSE(m_context.name, "Stopped connection timers.");
+            });
+        }
+
+    private:
+        enum class deadline_type : uint8_t {
+            auth,
+            idle,
+            read,
+            heartbeat
+        };
+
+        struct deadline_t {
+            uint64_t      connection_id = 0U;
+            deadline_type type          = deadline_type::auth;
+        };
+
+        struct pool_t {
+            std::vector<std::unique_ptr<connection_t>> idle;
+            size_t                                      capacity = 0U;
+            std::mutex                                  mutex;
+        };
+
     private:
         context_t& m_context;
-        uint64_t   m_id_count = 1U;
+
+        std::shared_ptr<pool_t> m_pool = std::make_shared<pool_t>();
+
+        timer_wheel<deadline_t> m_timers;
+        std::mutex              m_timers_mutex;
+
+        std::unordered_map<std::string, uint32_t> m_admitted_per_ip;
+        size_t                                    m_admitted               = 0U;
+        uint32_t                                  m_max_connections        = 0U;
+        uint32_t                                  m_max_connections_per_ip = 0U;
+        token_bucket                              m_accept_bucket;
+        std::mutex                                m_admission_mutex;
+
+        std::condition_variable m_waiters_cv;
+        std::mutex              m_waiters_mutex;
+        std::atomic_uint32_t    m_waiters = 0U;
 
     private:
+        /*
+            Reset a released connection and keep it if the pool still exists and has room.
+        */
+        static void recycle(std::weak_ptr<pool_t> weak_pool, connection_t* released) {
+            std::unique_ptr<connection_t> connection(released);
+
+            auto pool = weak_pool.lock();
+            if (!pool)
+                return;
+
+            {
+                std::lock_guard<std::mutex> guard(pool->mutex);
+
+                if (pool->idle.size() >= pool->capacity)
+                    return;
+            }
+
+            connection->reset();
+
+            std::lock_guard<std::mutex> guard(pool->mutex);
+
+            if (pool->idle.size() < pool->capacity)
+                pool->idle.push_back(std::move(connection));
+        }
+
+        /*
+            Block until predicate holds, woken by closed connections and flushed writers.
+            Returns false if deadline passed or the io context stopped first.
+        */
+        template<typename Predicate>
+        bool wait_until(std::chrono::steady_clock::time_point deadline, Predicate predicate) {
+            // A stopped io context doesn't wake anyone, check on it every so often
+            constexpr auto stopped_check_interval = std::chrono::milliseconds(100);
+
+            m_waiters++;
+
+            std::unique_lock<std::mutex> lock(m_waiters_mutex);
+            bool                         done = predicate();
+
+            while (!done && !m_context.io_context.stopped()) {
+                auto now = std::chrono::steady_clock::now();
+
+                if (now >= deadline)
+                    break;
+
+                m_waiters_cv.wait_until(lock, std::min(deadline, now + stopped_check_interval));
+                done = predicate();
+            }
+
+            m_waiters--;
+            return done;
+        }
+
+        void notify_waiters() {
+            // Taking the mutex orders the notify after a waiter's predicate check
+            { std::lock_guard<std::mutex> guard(m_waiters_mutex); }
+            m_waiters_cv.notify_all();
+        }
+
+        bool has_pending_writes() {
+            std::shared_lock<std::shared_mutex> guard(connections_mutex);
+
+            for (auto& connection : connections) {
+                if (connection && connection->is_connected() && connection->has_pending_writes())
+                    return true;
+            }
+
+            return false;
+        }
+
+        uint64_t get_tick_ms() const {
+            return std::max<uint64_t>(m_context.settings.timer_tick_ms, 1U);
+        }
+
+        /*
+            Convert ms to ticks, rounded up and counting the current tick as already elapsed.
+        */
+        uint64_t to_ticks(uint64_t ms) const {
+            uint64_t tick_ms = get_tick_ms();
+            return (ms + tick_ms - 1U) / tick_ms + 1U;
+        }
+
+        void schedule_deadlines(std::shared_ptr<connection_t> connection) {
+            const auto& settings = m_context.settings;
+            uint64_t    id       = connection->get_id();
+
+            std::lock_guard<std::mutex> guard(m_timers_mutex);
+
+            connection->auth_timer_id = m_timers.schedule(to_ticks(settings.auth_deadline_sec * 1000ULL),
+                deadline_t{ id, deadline_type::auth });
+
+            if (settings.idle_timeout_sec) {
+                connection->idle_timer_id = m_timers.schedule(to_ticks(settings.idle_timeout_sec * 1000ULL),
+                    deadline_t{ id, deadline_type::idle });
+            }
+
+            if (settings.read_timeout_sec) {
+                connection->read_timer_id = m_timers.schedule(to_ticks(settings.read_timeout_sec * 1000ULL),
+                    deadline_t{ id, deadline_type::read });
+            }
+
+            if (settings.heartbeat_interval_sec) {
+                connection->heartbeat_timer_id = m_timers.schedule(to_ticks(settings.heartbeat_interval_sec * 1000ULL),
+                    deadline_t{ id, deadline_type::heartbeat });
+            }
+        }
+
+        void cancel_deadlines(connection_t& connection) {
+            std::lock_guard<std::mutex> guard(m_timers_mutex);
+
+            m_timers.cancel(connection.auth_timer_id);
+            m_timers.cancel(connection.idle_timer_id);
+            m_timers.cancel(connection.read_timer_id);
+            m_timers.cancel(connection.heartbeat_timer_id);
+        }
+
+        void on_deadline(const deadline_t& deadline, uint64_t now) {
+            std::shared_ptr<connection_t> connection;
+
+            {
+                std::shared_lock<std::shared_mutex> guard(connections_mutex);
+
+                auto found = connections.find(deadline.connection_id);
+                if (!found || !*found)
+                    return;
+
+                connection = *found;
+            }
+
+            if (!connection->is_connected())
+                return;
+
+            switch (deadline.type) {
+                case deadline_type::auth: {
+                    if (connection->is_authenticated)
+                        return;
+
+                    return expire(connection, libnetwrk::disconnect_code::authentication_failed);
+                }
+                case deadline_type::idle: {
+                    uint64_t last_activity = std::max(connection->last_receive_timestamp.load(),
+                        connection->last_send_timestamp.load());
+
+                    return check_inactivity(connection, deadline, now, last_activity,
+                        m_context.settings.idle_timeout_sec * 1000ULL, connection->idle_timer_id);
+                }
+                case deadline_type::read: {
+                    return check_inactivity(connection, deadline, now, connection->last_receive_timestamp,
+                        m_context.settings.read_timeout_sec * 1000ULL, connection->read_timer_id);
+                }
+                case deadline_type::heartbeat: {
+                    return check_heartbeat(connection, deadline, now);
+                }
+
+                default: return;
+            }
+        }
+
+        /*
+            Disconnect if inactive for timeout_ms, otherwise push the deadline back by the remaining time.
+        */
+        void check_inactivity(std::shared_ptr<connection_t> connection, const deadline_t& deadline, uint64_t now,
+            uint64_t last_activity, uint64_t timeout_ms, uint64_t& timer_id)
+        {
+            if (timeout_ms == 0U)
+                return;
+
+            uint64_t elapsed = now > last_activity ? now - last_activity : 0U;
+
+            if (elapsed >= timeout_ms) {
+                auto code = deadline.type == deadline_type::idle
+                    ? libnetwrk::disconnect_code::idle_timeout
+                    : libnetwrk::disconnect_code::read_timeout;
+
+                return expire(connection, code);
+            }
+
+            std::lock_guard<std::mutex> guard(m_timers_mutex);
+            timer_id = m_timers.schedule(to_ticks(timeout_ms - elapsed), deadline);
+        }
+
+        /*
+            Heartbeat a peer nothing was received from for an interval. Any received message,
+            not only an ack, counts as an answer so busy connections never send heartbeats.
+            Unauthenticated peers are left to the auth deadline.
+        */
+        void check_heartbeat(std::shared_ptr<connection_t> connection, const deadline_t& deadline, uint64_t now) {
+            uint64_t interval_ms   = m_context.settings.heartbeat_interval_sec * 1000ULL;
+            uint64_t last_received = connection->last_receive_timestamp;
+            uint64_t idle          = now > last_received ? now - last_received : 0U;
+
+            if (interval_ms == 0U)
+                return;
+
+            if (!connection->is_authenticated) {
+                std::lock_guard<std::mutex> guard(m_timers_mutex);
+                connection->heartbeat_timer_id = m_timers.schedule(to_ticks(interval_ms), deadline);
+                return;
+            }
+
+            if (idle >= interval_ms * (m_context.settings.heartbeat_max_missed + 1ULL))
+                return expire(connection, libnetwrk::disconnect_code::heartbeat_timeout);
+
+            uint64_t next_ms = interval_ms;
+
+            if (idle < interval_ms) {
+                next_ms = interval_ms - idle;
+            }
+            else {
+                shared_comp_system_message<Context>::send_heartbeat(*connection);
+            }
+
+            std::lock_guard<std::mutex> guard(m_timers_mutex);
+            connection->heartbeat_timer_id = m_timers.schedule(to_ticks(next_ms), deadline);
+        }
+
+        void expire(std::shared_ptr<connection_t> connection, libnetwrk::disconnect_code code) {
+            connection->disconnect_code = code;
+
+            if (m_context.cb_internal_disconnect)
+                m_context.cb_internal_disconnect(connection);
+        }
+
+        asio::awaitable<void> co_timers() {
+            asio::steady_timer      timer(m_context.io_context);
+            std::vector<deadline_t> expired;
+
+            uint64_t last_tick = get_steady_milliseconds_timestamp();
+
+            while (true) {
+                uint64_t tick_ms = get_tick_ms();
+
+                timer.expires_after(std::chrono::milliseconds(tick_ms));
+                auto [ec] = co_await timer.async_wait(asio::as_tuple(asio::use_awaitable));
+
+                if (ec)
+                    break;
+
+                // Catch up on ticks missed while the io thread was busy
+                uint64_t now   = get_steady_milliseconds_timestamp();
+                uint64_t ticks = (now - last_tick) / tick_ms;
+                last_tick     += ticks * tick_ms;
+
+                {
+                    std::lock_guard<std::mutex> guard(m_timers_mutex);
+
+                    m_timers.advance(ticks, [&expired](deadline_t& deadline) {
+                        expired.push_back(deadline);
+                    });
+                }
+
+                for (const auto& deadline : expired)
+                    on_deadline(deadline, now);
+
+                expired.clear();
+            }
+        }
+
         asio::awaitable<void> co_gc() {
             asio::steady_timer timer(m_context.io_context, std::chrono::seconds(m_context.settings.gc_freq_sec));
             
+            std::vector<std::shared_ptr<connection_t>> removed;
+
             size_t count_before = 0U;
             size_t count_after  = 0U;
 
@@ -83,38 +587,36 @@ namespace libnetwrk {
                     break;
 
                 {
-                    std::lock_guard<std::mutex> guard(connections_mutex);
+                    std::unique_lock<std::shared_mutex> guard(connections_mutex);
 
                     count_before = connections.size();
 
-                    connections.remove_if([this](auto& client) {
+                    // Closed connections remove themselves, this only catches stragglers
+                    connections.remove_if([&removed](auto& client) {
                         if (!client)
                             return true;
 
-                        if (!client->is_connected() && !client->cancel_cv.has_active_operations()) {
-                            if (m_context.cb_disconnect)
-                                m_context.cb_disconnect(client, client->disconnect_code);
-
+                        if (!client->is_connected() && !client->has_active_operations()) {
+                            removed.push_back(client);
                             return true;
                         }
 
-                        if (!client->is_authenticated) {
-                            uint64_t timestamp = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-
-                            if (timestamp > client->auth_request_deadline) {
-                                client->disconnect_code = libnetwrk::disconnect_code::authentication_failed;
-
-                                if (m_context.cb_internal_disconnect)
-                                    m_context.cb_internal_disconnect(client);
-                            }
-                        }
-
                         return false;
                     });
 
                     count_after = connections.size();
                 }
 
+                for (auto& client : removed) {
+                    cancel_deadlines(*client);
+                    release_admission(*client);
+
+                    if (m_context.cb_disconnect)
+                        m_context.cb_disconnect(client, client->disconnect_code);
+                }
+
+                removed.clear();
+
                 LIBNETWRK_DISABLE_FILE_LOG();
                 LIBNETWRK_VERBOSE(m_context.name, "GC total: {} ({})", count_after, 0 - (int64_t)(count_before - count_after));
                 LIBNETWRK_ENABLE_FILE_LOG();
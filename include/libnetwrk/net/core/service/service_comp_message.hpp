@@ -15,6 +15,7 @@ namespace libnetwrk {
         using connection_t       = context_t::connection_t;
         using message_t          = context_t::message_t;
         using outgoing_message_t = context_t::outgoing_message_t;
+        using owned_message_t    = context_t::owned_message_t;
 
         using send_predicate_t   = std::function<bool(std::shared_ptr<connection_t>)>;
 
@@ -41,7 +42,7 @@ namespace libnetwrk {
                 outgoing_message = std::make_shared<outgoing_message_t>(std::move(message));
             }
 
-            std::lock_guard<std::mutex> guard(m_comp_connection.connections_mutex);
+            std::shared_lock<std::shared_mutex> guard(m_comp_connection.connections_mutex);
             for (auto& client : m_comp_connection.connections) {
                 if (!client || !client->is_connected()) continue;
                 if (predicate && !predicate(client))    continue;
@@ -50,6 +51,29 @@ namespace libnetwrk {
             }
         }
 
+    protected:
+        /*
+            User messages sent optimistically behind the challenge response are queued
+            after it and held until it is verified, they are dropped if verification failed.
+        */
+        bool accept_message(owned_message_t& message) override {
+            auto sender = std::static_pointer_cast<typename context_t::connection_internal_t>(message.sender);
+
+            if (!sender)
+                return false;
+
+            if (sender->is_authenticated)
+                return true;
+
+            // Usually a client in trusted mode, which never answers the challenge
+            if (!sender->warned_unauthenticated) {
+                sender->warned_unauthenticated = true;
+                LIBNETWRK_WARNING(this->m_context.name, "[{}] Dropping user messages from an unauthenticated connection, check the auth modes.", sender->get_id());
+            }
+
+            return false;
+        }
+
     private:
         comp_connection_t& m_comp_connection;
     };
@@ -1,11 +1,13 @@
 #pragma once
 
 #include "libnetwrk/net/misc/authentication.hpp"
+#include "libnetwrk/net/core/shared/shared_comp_system_message.hpp"
 
 namespace libnetwrk {
     template<typename Context>
-    class service_comp_system_message {
+    class service_comp_system_message : public shared_comp_system_message<Context> {
     public:
+        using base_t                = shared_comp_system_message<Context>;
         using context_t             = Context;
         using connection_internal_t = context_t::connection_internal_t;
         using message_t             = context_t::message_t;
@@ -20,7 +22,13 @@ namespace libnetwrk {
             };
         }
 
-        void send_auth_message(std::shared_ptr<connection_internal_t> connection) {
+        /*
+            Challenge a new connection, trusted connections are verified right away.
+        */
+        void start_authentication(std::shared_ptr<connection_internal_t> connection) {
+            if (m_context.settings.auth == auth_mode::trusted)
+                return verified(connection);
+
             connection->auth_request = authentication::generate_request();
 
             message_t request{};
@@ -29,9 +37,6 @@ namespace libnetwrk {
             request << connection->auth_request;
 
             connection->send(request);
-
-            auto deadline                     = std::chrono::system_clock::now() + std::chrono::seconds(m_context.settings.auth_deadline_sec);
-            connection->auth_request_deadline = std::chrono::system_clock::to_time_t(deadline);
         }
 
     private:
@@ -42,34 +47,69 @@ namespace libnetwrk {
             switch (command) {
                 case system_command::c2s_verify:     return on_system_verify_message(message);
                 case system_command::cev_clock_sync: return on_system_clock_sync_message(message);
+                case system_command::heartbeat:      return this->on_system_heartbeat_message(message);
+                case system_command::heartbeat_ack:  return on_system_heartbeat_ack_message(message);
                 
-                default: return;
+                default: return protocol_violation(message);
             }
         }
 
+        /*
+            Disconnect a peer that sent an unknown or unsolicited system message.
+        */
+        void protocol_violation(owned_message_t* message) {
+            auto sender = std::static_pointer_cast<connection_internal_t>(message->sender);
+
+            LIBNETWRK_WARNING(m_context.name, "[{}] Received an unexpected system message.", sender->get_id());
+
+            sender->disconnect_code = libnetwrk::disconnect_code::protocol_violation;
+
+            if (m_context.cb_internal_disconnect)
+                m_context.cb_internal_disconnect(sender);
+        }
+
         void on_system_verify_message(owned_message_t* message) {
             auto sender = std::static_pointer_cast<connection_internal_t>(message->sender);
 
+            // Only a single response to an outstanding challenge is expected
+            if (sender->is_authenticated || m_context.settings.auth == auth_mode::trusted)
+                return protocol_violation(message);
+
             authentication::response_t auth_response{};
-            message->message >> auth_response;
+
+            if (message->message.try_read(auth_response) != deserialize_error::none)
+                return sender->stop();
 
             if (!authentication::validate(sender->auth_request, auth_response))
                 return sender->stop();
 
-            sender->is_authenticated = true;
+            verified(sender);
+        }
+
+        void verified(std::shared_ptr<connection_internal_t> connection) {
+            connection->is_authenticated = true;
 
             message_t response{};
             response.head.type    = message_type::system;
             response.head.command = static_cast<uint64_t>(system_command::s2c_verify_ok);
 
-            sender->send(response);
+            connection->send(response);
+        }
+
+        void on_system_heartbeat_ack_message(owned_message_t* message) {
+            if (m_context.settings.heartbeat_interval_sec == 0U)
+                return protocol_violation(message);
+
+            base_t::on_system_heartbeat_ack_message(message);
         }
 
         void on_system_clock_sync_message(owned_message_t* message) {
             uint8_t  sample_index     = 0U;
             uint64_t client_timestamp = 0U;
 
-            message->message >> sample_index >> client_timestamp;
+            if (message->message.try_read(sample_index)     != deserialize_error::none ||
+                message->message.try_read(client_timestamp) != deserialize_error::none)
+                return;
 
             message_t response{};
             response.head.type    = message_type::system;
@@ -78,5 +118,6 @@ namespace libnetwrk {
 
             message->sender->send(response);
         }
+
     };
 }
\ No newline at end of file
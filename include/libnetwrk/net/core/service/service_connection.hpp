@@ -3,6 +3,8 @@
 #include "libnetwrk/net/core/shared/shared_connection.hpp"
 #include "libnetwrk/net/messages/owned_message.hpp"
 
+#include <memory>
+
 namespace libnetwrk {
     template<typename Desc, typename Socket>
     class service_connection : public shared_connection<Desc, Socket> {
@@ -45,6 +47,13 @@ namespace libnetwrk {
     protected:
         virtual void notify() override {}
 
+        void reset_service_state() {
+            this->reset_shared_state();
+
+            std::destroy_at(&m_storage);
+            std::construct_at(&m_storage);
+        }
+
         virtual void direct_send(const std::shared_ptr<outgoing_message_t> outgoing_message) override {
             base_t::direct_send(outgoing_message);
         }
@@ -14,6 +14,7 @@ namespace libnetwrk {
         using command_t          = base_t::command_t;
         using connection_t       = service_connection_internal<Desc, Socket>;
         using endpoint_t         = typename Socket::endpoint_t;
+        using native_socket_t    = typename Socket::native_socket_t;
         using message_t          = base_t::message_t;
         using owned_message_t    = base_t::owned_message_t;
         using outgoing_message_t = base_t::outgoing_message_t;
@@ -24,30 +25,50 @@ namespace libnetwrk {
         service_connection_internal(connection_t&&)      = default;
 
         service_connection_internal(io_context_t& context)
-            : base_t(context), write_cv(context), cancel_cv(context)
+            : base_t(context), write_event(context), stop_event(context)
         {
-            is_authenticated      = false;
-            auth_request          = {};
-            auth_request_deadline = 0U;
-            disconnect_code       = libnetwrk::disconnect_code::unspecified;
+            reset_internal_state();
         }
 
         connection_t& operator=(const connection_t&) = delete;
         connection_t& operator=(connection_t&&)      = default;
 
     public:
-        std::atomic_bool           is_authenticated;
+        // Wakes the writer for new messages, closed on stop
+        async_event write_event;
+
+        // Closed on stop, interrupts the reader's rate limit delay
+        async_event stop_event;
+
+        // Steady ms timestamps of the last complete read and write
+        std::atomic_uint64_t last_receive_timestamp;
+        std::atomic_uint64_t last_send_timestamp;
+
+        // Deadline timers, owned by the connection component
+        uint64_t auth_timer_id      = 0U;
+        uint64_t idle_timer_id      = 0U;
+        uint64_t read_timer_id      = 0U;
+        uint64_t heartbeat_timer_id = 0U;
+
         authentication::request_t  auth_request;
-        uint64_t                   auth_request_deadline;
         libnetwrk::disconnect_code disconnect_code;
+        std::atomic_bool           is_authenticated;
+
+        // Set while a message taken off the outgoing queues is being written
+        std::atomic_bool is_writing = false;
 
-        coroutine_cv write_cv;
-        coroutine_cv cancel_cv;
+        // Counted against the accept limits
+        bool is_admitted = false;
+
+        // Dropping user messages before authentication was logged, message processing only
+        bool warned_unauthenticated = false;
+
+        // Read and write coroutines still running
+        std::atomic_uint8_t active_operations = 0U;
 
     public:
         bool wait_for_messages() {
-            std::unique_lock<std::mutex> lock(this->m_outgoing_mutex);
-            return this->m_outgoing_system_messages.empty() && this->m_outgoing_messages.empty();
+            return !has_system_messages() && !has_user_messages();
         }
 
         bool has_user_messages() {
@@ -58,15 +79,37 @@ namespace libnetwrk {
             return !this->m_outgoing_system_messages.empty();
         }
 
-        std::queue<std::shared_ptr<outgoing_message_t>>& get_user_messages()   { return this->m_outgoing_messages; }
-        std::queue<std::shared_ptr<outgoing_message_t>>& get_system_messages() { return this->m_outgoing_system_messages; }
-        std::mutex&                                      get_outgoing_mutex()  { return this->m_outgoing_mutex; }
+        bool has_active_operations() {
+            return active_operations != 0U;
+        }
+
+        /*
+            Check if any outgoing message is queued or being written.
+        */
+        bool has_pending_writes() {
+            return is_writing || has_system_messages() || has_user_messages();
+        }
+
+        /*
+            Take the next message to write, system messages first. Writer only.
+            is_writing is raised before taking, so the message is never invisible to has_pending_writes.
+        */
+        std::shared_ptr<outgoing_message_t> pop_outgoing_message() {
+            std::shared_ptr<outgoing_message_t> message;
+            is_writing = true;
+
+            if (!this->m_outgoing_system_messages.try_pop(message))
+                this->m_outgoing_messages.try_pop(message);
+
+            is_writing = message != nullptr;
+            return message;
+        }
 
     public:
         void stop() override final {
             base_t::stop();
-            write_cv.notify_all();
-            cancel_cv.notify_all();
+            write_event.close();
+            stop_event.close();
         }
 
         void direct_send(const std::shared_ptr<outgoing_message_t> outgoing_message) override final {
@@ -78,6 +121,21 @@ namespace libnetwrk {
             this->m_socket.connect(endpoint);
         }
 
+        /*
+            Take ownership of an accepted socket.
+        */
+        void accept(native_socket_t&& socket, std::string remote_ip, uint16_t remote_port) {
+            this->m_socket = Socket(std::move(socket), std::move(remote_ip), remote_port);
+        }
+
+        void add_rtt_sample(uint64_t sample_us) {
+            this->update_rtt(sample_us);
+        }
+
+        void add_rate_limit_violation() {
+            this->m_rate_limit_violations++;
+        }
+
         Socket& get_socket() {
             return this->m_socket;
         }
@@ -86,6 +144,14 @@ namespace libnetwrk {
             this->m_id = id;
         }
 
+        /*
+            Reset a stopped connection for reuse.
+        */
+        void reset() {
+            this->reset_service_state();
+            reset_internal_state();
+        }
+
         asio::awaitable<void> co_read_message(message_t& recv_message, std::error_code& ec) {
             return base_t::base_t::co_read_message(recv_message, ec);
         }
@@ -96,7 +162,26 @@ namespace libnetwrk {
 
     protected:
         void notify() override final {
-            write_cv.notify_one();
+            write_event.notify_one();
+        }
+
+    private:
+        void reset_internal_state() {
+            is_authenticated       = false;
+            auth_request           = {};
+            disconnect_code        = libnetwrk::disconnect_code::unspecified;
+            last_receive_timestamp = get_steady_milliseconds_timestamp();
+            last_send_timestamp    = last_receive_timestamp.load();
+            is_writing             = false;
+            is_admitted            = false;
+            warned_unauthenticated = false;
+            auth_timer_id          = 0U;
+            idle_timer_id          = 0U;
+            read_timer_id          = 0U;
+            heartbeat_timer_id     = 0U;
+
+            write_event.reset();
+            stop_event.reset();
         }
     };
 }
\ No newline at end of file
@@ -9,8 +9,29 @@
 
 namespace libnetwrk {
     struct service_settings {
-        uint8_t gc_freq_sec       = 15U;
-        uint8_t auth_deadline_sec = 10U;
+        uint8_t  gc_freq_sec       = 15U;
+        uint8_t  auth_deadline_sec = 10U;
+        uint16_t idle_timeout_sec  = 0U;      // 0 to disable
+        uint16_t read_timeout_sec  = 0U;      // 0 to disable
+        uint16_t timer_tick_ms     = 100U;    // Resolution of connection deadlines
+        uint8_t  pending_accepts   = 4U;      // Accepts kept outstanding on the listening socket
+
+        uint16_t heartbeat_interval_sec = 0U;     // Heartbeat after this long without receiving, 0 to disable
+        uint8_t  heartbeat_max_missed   = 3U;     // Disconnect after this many unanswered heartbeats
+
+        // Accept-storm protection, excess connections are closed right after accept. 0 to disable.
+        uint32_t max_connections        = 0U;
+        uint32_t max_connections_per_ip = 0U;
+        uint32_t accept_rate_per_sec    = 0U;
+        uint32_t accept_burst           = 0U;     // Connections accepted at once before accept_rate_per_sec applies
+
+        inbound_rate_limit inbound_limit;
+        deserialize_limits decode_limits = { .max_allocation_ratio = 64U };     // Applied to each received message
+        auth_mode          auth          = auth_mode::challenge;                // Optimistic clients are served in challenge mode too
+        bool               compact       = false;                               // Read received user messages as compact, clients send them compact
+
+        uint32_t connection_pool_size   = 0U;     // Released connections kept for reuse, 0 to disable pooling
+        uint32_t connection_pool_warmup = 0U;     // Connections constructed up front on start
     };
 
     template<typename Connection>
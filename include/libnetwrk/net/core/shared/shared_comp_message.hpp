@@ -1,16 +1,21 @@
 #pragma once
 
 #include "asio.hpp"
+#include "asio/experimental/awaitable_operators.hpp"
 #include "libnetwrk/net/messages/owned_message.hpp"
 #include "libnetwrk/net/messages/outgoing_message.hpp"
 #include "libnetwrk/net/misc/timestamp.hpp"
 #include "libnetwrk/net/misc/crc32.hpp"
+#include "libnetwrk/net/misc/token_bucket.hpp"
 #include "libnetwrk/exceptions/libnetwrk_exception.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <queue>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
+#include <atomic>
 #include <exception>
 
 namespace libnetwrk {
@@ -50,18 +55,24 @@ namespace libnetwrk {
             return true;
         }
 
+        /*
+            Start reading and writing. Both stop on their own, the reader
+            when the socket closes and the writer when write_event closes.
+        */
         void start_connection_read_and_write(std::shared_ptr<connection_t> connection) {
-            using namespace asio::experimental::awaitable_operators;
+            connection->active_operations = 2U;
 
-            asio::co_spawn(m_context.io_context, this->co_read(connection) || connection->cancel_cv.wait(),
-                [this, connection](auto, auto) {
+            asio::co_spawn(m_context.io_context, this->co_read(connection),
+                [this, connection](auto) {
                     LIBNETWRK_DEBUG(m_context.name, "[{}] Stopped reading messages.", connection->get_id());
+                    on_read_or_write_stopped(connection);
                 }
             );
 
-            asio::co_spawn(m_context.io_context, this->co_write(connection) || connection->cancel_cv.wait(),
-                [this, connection](auto, auto) {
+            asio::co_spawn(m_context.io_context, this->co_write(connection),
+                [this, connection](auto) {
                     LIBNETWRK_DEBUG(m_context.name, "[{}] Stopped writing messages.", connection->get_id());
+                    on_read_or_write_stopped(connection);
                 }
             );
         }
@@ -83,6 +94,15 @@ namespace libnetwrk {
     protected:
         context_t& m_context;
 
+    protected:
+        /*
+            Check a user message before its callback, rejected messages are dropped.
+        */
+        virtual bool accept_message(owned_message_t& message) {
+            (void)message;
+            return true;
+        }
+
     private:
         std::queue<owned_message_t> m_incoming_messages;
         std::queue<owned_message_t> m_incoming_system_messages;
@@ -92,9 +112,46 @@ namespace libnetwrk {
         std::thread                 m_process_messages_thread;
 
     private:
+        void on_rate_limit_violation(std::shared_ptr<connection_t>& connection) {
+            connection->add_rate_limit_violation();
+            m_context.rate_limit_violations++;
+        }
+
+        static bool is_verify_message(const message_t& message) {
+            return message.head.type == message_type::system
+                && message.head.command == static_cast<uint64_t>(system_command::c2s_verify);
+        }
+
+        // Longest the reader is delayed for a single message
+        static constexpr double max_delay_sec = 1.0;
+
+        // The last of read and write to stop reports the connection as closed
+        void on_read_or_write_stopped(std::shared_ptr<connection_t> connection) {
+            if (--connection->active_operations != 0U)
+                return;
+
+            if (m_context.cb_internal_closed)
+                m_context.cb_internal_closed(connection);
+        }
+
         asio::awaitable<void> co_read(std::shared_ptr<connection_t> connection) {
+            using namespace asio::experimental::awaitable_operators;
+
             std::error_code ec = {};
 
+            const auto& limit = m_context.settings.inbound_limit;
+
+            token_bucket message_bucket(limit.messages_per_sec, std::max(limit.message_burst, limit.messages_per_sec));
+            token_bucket byte_bucket(limit.bytes_per_sec, std::max(limit.byte_burst, limit.bytes_per_sec));
+
+            // System messages get their own budget while limiting, so library traffic doesn't eat the user limit
+            bool         limited     = message_bucket.is_limited() || byte_bucket.is_limited();
+            uint32_t     system_rate = limited ? limit.system_messages_per_sec : 0U;
+            token_bucket system_bucket(system_rate, system_rate);
+
+            // Only the first challenge response is free, it must not be delayed past the auth deadline
+            bool verify_exempt = true;
+
             LIBNETWRK_DEBUG(m_context.name, "[{}] Started reading messages.", connection->get_id());
 
             while (true) {
@@ -117,7 +174,58 @@ namespace libnetwrk {
                     break;
                 }
 
-                owned_message.sender = connection;
+                owned_message.sender               = connection;
+                connection->last_receive_timestamp = get_steady_milliseconds_timestamp();
+
+                // Enforce inbound rate limit before spending any more work on the message
+                bool charge = limited;
+
+                if (charge && verify_exempt && !connection->is_authenticated && is_verify_message(owned_message.message)) {
+                    verify_exempt = false;
+                    charge        = false;
+                }
+
+                if (charge) {
+                    token_bucket& count_bucket = owned_message.message.head.type == message_type::system ? system_bucket : message_bucket;
+
+                    double bytes = static_cast<double>(message_t::message_head_t::size + owned_message.message.head.data_size);
+
+                    if (limit.action == rate_limit_action::delay) {
+                        // Debt is capped so a single oversized message can't park the reader for long
+                        uint64_t wait_us = std::max(count_bucket.consume(1.0, max_delay_sec), byte_bucket.consume(bytes, max_delay_sec));
+
+                        if (wait_us) {
+                            on_rate_limit_violation(connection);
+
+                            // Not reading lets TCP flow control push back on the peer, stopping ends the wait
+                            asio::steady_timer timer(m_context.io_context, std::chrono::microseconds(wait_us));
+                            co_await (timer.async_wait(asio::as_tuple(asio::use_awaitable)) || connection->stop_event.wait());
+
+                            if (!connection->is_connected())
+                                break;
+                        }
+                    }
+                    // Check both before taking from either, so a rejected message costs nothing
+                    else if (!count_bucket.can_consume() || !byte_bucket.can_consume(bytes)) {
+                        on_rate_limit_violation(connection);
+
+                        if (limit.action == rate_limit_action::drop)
+                            continue;
+
+                        LIBNETWRK_WARNING(m_context.name, "[{}] Exceeded inbound rate limit. Disconnecting.", connection->get_id());
+
+                        connection->disconnect_code = libnetwrk::disconnect_code::rate_limited;
+
+                        if (m_context.cb_internal_disconnect)
+                            m_context.cb_internal_disconnect(connection);
+
+                        break;
+                    }
+                    else {
+                        count_bucket.try_consume();
+                        byte_bucket.try_consume(bytes);
+                    }
+                }
 
             #ifndef LIBNETWRK_DISABLE_CRC
                 // Verify CRC32
@@ -134,6 +242,13 @@ namespace libnetwrk {
                     owned_message.message.head.data_size = owned_message.message.data.size();
                 }
 
+                // Bounds what deserializing the message can allocate by its size
+                owned_message.message.data.set_deserialize_limits(m_context.settings.decode_limits);
+
+                // System messages always use the default encoding
+                if (owned_message.message.head.type != message_type::system)
+                    owned_message.message.data.set_compact(m_context.settings.compact);
+
                 {
                     std::lock_guard<std::mutex> guard(this->m_incoming_mutex);
 
@@ -163,29 +278,13 @@ namespace libnetwrk {
                     break;
 
                 if (connection->wait_for_messages())
-                    co_await connection->write_cv.wait();
+                    co_await connection->write_event.wait();
 
                 if (!connection->is_connected())
                     break;
 
                 while (true) {
-                    std::shared_ptr<outgoing_message_t> send_message;
-
-                    {
-                        std::lock_guard<std::mutex> guard(connection->get_outgoing_mutex());
-
-                        auto& user_messages = connection->get_user_messages();
-                        auto& system_messages = connection->get_system_messages();
-
-                        if (connection->has_system_messages()) {
-                            send_message = system_messages.front();
-                            system_messages.pop();
-                        }
-                        else if (connection->has_user_messages()) {
-                            send_message = user_messages.front();
-                            user_messages.pop();
-                        }
-                    }
+                    std::shared_ptr<outgoing_message_t> send_message = connection->pop_outgoing_message();
 
                     if (!send_message)
                         break;
@@ -214,6 +313,7 @@ namespace libnetwrk {
                     }
 
                     co_await connection->co_write_message(send_message, ec);
+                    connection->is_writing = false;
 
                     if (ec) {
                         if (ec != asio::error::eof && ec != asio::error::connection_reset && ec != asio::error::operation_aborted) {
@@ -225,10 +325,15 @@ namespace libnetwrk {
 
                         break;
                     }
+
+                    connection->last_send_timestamp = get_steady_milliseconds_timestamp();
                 }
 
                 if (ec)
                     break;
+
+                if (m_context.cb_internal_flushed)
+                    m_context.cb_internal_flushed(connection);
             }
         }
 
@@ -277,6 +382,9 @@ namespace libnetwrk {
                     m_context.cb_system_message(static_cast<system_command>(message.message.head.command), &message);
                 }
                 else {
+                    if (!accept_message(message))
+                        return true;
+
                     if (!m_context.cb_message)
                         throw libnetwrk_exception("Message callback not set.");
 
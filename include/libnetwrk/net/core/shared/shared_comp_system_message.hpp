@@ -0,0 +1,60 @@
+#pragma once
+
+#include "libnetwrk/net/core/system_commands.hpp"
+#include "libnetwrk/net/enum/enums.hpp"
+#include "libnetwrk/net/misc/timestamp.hpp"
+
+#include <memory>
+
+namespace libnetwrk {
+    /*
+        System messages handled the same way by clients and services.
+    */
+    template<typename Context>
+    class shared_comp_system_message {
+    public:
+        using context_t             = Context;
+        using connection_internal_t = context_t::connection_internal_t;
+        using message_t             = context_t::message_t;
+        using owned_message_t       = context_t::owned_message_t;
+
+    public:
+        /*
+            Send a heartbeat carrying the current steady timestamp, echoed back in the ack.
+        */
+        static void send_heartbeat(connection_internal_t& connection) {
+            message_t heartbeat{};
+            heartbeat.head.type    = message_type::system;
+            heartbeat.head.command = static_cast<uint64_t>(system_command::heartbeat);
+            heartbeat << get_steady_microseconds_timestamp();
+
+            connection.send(heartbeat);
+        }
+
+    protected:
+        void on_system_heartbeat_message(owned_message_t* message) {
+            uint64_t timestamp = 0U;
+
+            if (message->message.try_read(timestamp) != deserialize_error::none)
+                return;
+
+            message_t response{};
+            response.head.type    = message_type::system;
+            response.head.command = static_cast<uint64_t>(system_command::heartbeat_ack);
+            response << timestamp;
+
+            message->sender->send(response);
+        }
+
+        void on_system_heartbeat_ack_message(owned_message_t* message) {
+            uint64_t timestamp = 0U;
+            uint64_t now       = get_steady_microseconds_timestamp();
+
+            if (message->message.try_read(timestamp) != deserialize_error::none)
+                return;
+
+            if (timestamp <= now)
+                std::static_pointer_cast<connection_internal_t>(message->sender)->add_rtt_sample(now - timestamp);
+        }
+    };
+}
@@ -3,12 +3,15 @@
 #include "asio.hpp"
 #include "libnetwrk/net/messages/message.hpp"
 #include "libnetwrk/net/messages/outgoing_message.hpp"
+#include "libnetwrk/net/containers/mpsc_queue.hpp"
 #include "libnetwrk/net/misc/timestamp.hpp"
 #include "libnetwrk/net/enum/enums.hpp"
 
 #include <string>
-#include <queue>
-#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <algorithm>
 
 namespace libnetwrk {
     template<typename Desc, typename Socket>
@@ -20,6 +23,7 @@ namespace libnetwrk {
         using connection_t       = shared_connection<Desc, Socket>;
         using message_t          = message<Desc>;
         using outgoing_message_t = outgoing_message<Desc>;
+        using outgoing_queue_t   = mpsc_queue<std::shared_ptr<outgoing_message_t>>;
 
     public:
         shared_connection()                    = delete;
@@ -36,14 +40,14 @@ namespace libnetwrk {
         /*
             Get ip address.
         */
-        std::string get_ip() {
+        const std::string& get_ip() const {
             return m_socket.get_ip();
         }
 
         /*
             Get port.
         */
-        uint16_t get_port() {
+        uint16_t get_port() const {
             return m_socket.get_port();
         }
 
@@ -61,6 +65,22 @@ namespace libnetwrk {
             return m_socket.is_connected();
         }
 
+        /*
+            Get smoothed round trip time measured by heartbeats sent from this side.
+            0 until the first heartbeat is acknowledged. A peer that heartbeats first
+            suppresses our own heartbeats, so only one side may have an estimate.
+        */
+        std::chrono::microseconds get_rtt() const {
+            return std::chrono::microseconds(m_rtt_us.load());
+        }
+
+        /*
+            Get number of messages that exceeded the inbound rate limit.
+        */
+        uint32_t get_rate_limit_violations() {
+            return m_rate_limit_violations;
+        }
+
     public:
         void send(message_t& message, libnetwrk::send_flags flags = libnetwrk::send_flags::none) {
             std::shared_ptr<outgoing_message_t> outgoing_message;
@@ -84,16 +104,46 @@ namespace libnetwrk {
         socket_t m_socket;
         uint64_t m_id = 0U;
 
-        std::queue<std::shared_ptr<outgoing_message_t>> m_outgoing_messages;
-        std::queue<std::shared_ptr<outgoing_message_t>> m_outgoing_system_messages;
-        std::mutex                                      m_outgoing_mutex;
+        std::atomic_uint32_t m_rtt_us                = 0U;
+        std::atomic_uint32_t m_rate_limit_violations = 0U;
+
+        // Outgoing lanes, written from any thread and drained by the writer coroutine
+        outgoing_queue_t m_outgoing_messages;
+        outgoing_queue_t m_outgoing_system_messages;
 
     protected:
         virtual void notify() {};
 
-        virtual void direct_send(const std::shared_ptr<outgoing_message_t> outgoing_message) {
-            std::lock_guard<std::mutex> guard(m_outgoing_mutex);
+        /*
+            Return to the freshly constructed state so the object can be reused.
+            Only called once the writer has stopped.
+        */
+        void reset_shared_state() {
+            m_socket.close();
+            m_id                    = 0U;
+            m_rtt_us                = 0U;
+            m_rate_limit_violations = 0U;
+
+            m_outgoing_messages.clear();
+            m_outgoing_system_messages.clear();
+        }
+
+        /*
+            Add a rtt sample, smoothed the same way TCP smooths its rtt (1/8 gain).
+        */
+        void update_rtt(uint64_t sample_us) {
+            uint64_t clamped = std::min<uint64_t>(sample_us, std::numeric_limits<uint32_t>::max());
+            uint64_t current = m_rtt_us.load();
 
+            if (current == 0U) {
+                m_rtt_us = static_cast<uint32_t>(std::max<uint64_t>(clamped, 1U));
+            }
+            else {
+                m_rtt_us = static_cast<uint32_t>((current * 7U + clamped) / 8U);
+            }
+        }
+
+        virtual void direct_send(const std::shared_ptr<outgoing_message_t> outgoing_message) {
             if (outgoing_message->message.head.type == message_type::system) {
                 m_outgoing_system_messages.push(outgoing_message);
             }
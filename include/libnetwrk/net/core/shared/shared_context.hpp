@@ -4,7 +4,7 @@
 #include "libnetwrk/net/containers/dynamic_buffer.hpp"
 #include "libnetwrk/net/core/system_commands.hpp"
 #include "libnetwrk/net/enum/enums.hpp"
-#include "libnetwrk/net/misc/coroutine_cv.hpp"
+#include "libnetwrk/net/misc/async_event.hpp"
 
 #include <string>
 #include <memory>
@@ -13,6 +13,21 @@
 #include <functional>
 
 namespace libnetwrk {
+    /*
+        Per connection inbound rate limit, 0 disables a limit.
+        Bursts default to one second worth of the rate.
+        While either limit is set, system messages count against bytes_per_sec and
+        system_messages_per_sec instead of messages_per_sec.
+    */
+    struct inbound_rate_limit {
+        uint32_t          messages_per_sec        = 0U;
+        uint32_t          bytes_per_sec           = 0U;
+        uint32_t          message_burst           = 0U;
+        uint32_t          byte_burst              = 0U;
+        uint32_t          system_messages_per_sec = 20U;
+        rate_limit_action action                  = rate_limit_action::delay;
+    };
+
     template<typename Connection>
     class shared_context {
     public:
@@ -30,25 +45,31 @@ namespace libnetwrk {
         using cb_system_message_t       = std::function<void(system_command, owned_message_t*)>;  
         using cb_connect_t              = std::function<void(std::shared_ptr<connection_t>)>;
         using cb_internal_disconnect_t  = std::function<void(std::shared_ptr<connection_internal_t>)>;
+        using cb_internal_closed_t      = std::function<void(std::shared_ptr<connection_internal_t>)>;
+        using cb_internal_flushed_t     = std::function<void(std::shared_ptr<connection_internal_t>)>;
         using cb_pre_process_message_t  = std::function<void(dynamic_buffer*)>;
         using cb_post_process_message_t = std::function<void(dynamic_buffer*)>;
 
     public:
         shared_context()
-            : io_context(1), cancel_cv(io_context) {}
+            : io_context(1), cancel_event(io_context) {}
 
     public:
         std::string         name        = "";
         std::atomic_uint8_t status      = to_underlying(libnetwrk::service_status::stopped);
         std::atomic_int32_t clock_drift = 0U;
 
+        std::atomic_uint64_t rate_limit_violations = 0U;
+
         io_context_t io_context;
-        coroutine_cv cancel_cv;
+        async_event  cancel_event;
 
         cb_message_t              cb_message;
         cb_system_message_t       cb_system_message;
         cb_connect_t              cb_connect;
         cb_internal_disconnect_t  cb_internal_disconnect;
+        cb_internal_closed_t      cb_internal_closed;         // Read and write both stopped, called on the io thread
+        cb_internal_flushed_t     cb_internal_flushed;        // Outgoing queue written out, called on the io thread
         cb_pre_process_message_t  cb_pre_process_message;
         cb_post_process_message_t cb_post_process_message;
 
@@ -59,6 +80,7 @@ namespace libnetwrk {
 
         void start_io_context() {
             io_context.reset();
+            cancel_event.reset();
 
             m_io_context_thread = std::thread([this] { 
                 this->io_context.run(); 
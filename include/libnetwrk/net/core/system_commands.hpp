@@ -8,6 +8,8 @@ namespace libnetwrk {
         s2c_verify,
         s2c_verify_ok,
         cev_clock_sync,
-        sev_clock_sync
+        sev_clock_sync,
+        heartbeat,          // Either side, carries the sender's steady timestamp
+        heartbeat_ack       // Echoes the heartbeat timestamp back
     };
 }
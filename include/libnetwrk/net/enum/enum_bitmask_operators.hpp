@@ -5,6 +5,8 @@
         https://github.com/p-ranav/alpaca
 */
 
+#include "libnetwrk/net/type_traits.hpp"
+
 #include <type_traits>
 
 namespace libnetwrk {
@@ -20,6 +20,34 @@ namespace libnetwrk {
 
     enum class disconnect_code : uint8_t {
         unspecified           = 0,
-        authentication_failed = 1
+        authentication_failed = 1,
+        idle_timeout          = 2,      // No messages sent or received within idle_timeout_sec
+        read_timeout          = 3,      // No messages received within read_timeout_sec
+        heartbeat_timeout     = 4,      // Peer didn't answer heartbeat_max_missed heartbeats
+        rate_limited          = 5,      // Peer exceeded the inbound rate limit
+        protocol_violation    = 6       // Peer sent an unknown or unsolicited system message
+    };
+
+    enum class rate_limit_action : uint8_t {
+        delay      = 0,     // Stop reading until the peer is within the limit again, a second per message at most
+        drop       = 1,     // Drop messages over the limit
+        disconnect = 2      // Disconnect the peer
+    };
+
+    enum class auth_mode : uint8_t {
+        challenge  = 0,     // Client holds user messages until the service verified its challenge response
+        optimistic = 1,     // Client sends user messages right behind its challenge response, service holds them until verified
+        trusted    = 2      // No challenge, for trusted transports only. Set on both ends
+    };
+
+    enum class deserialize_error : uint8_t {
+        none          = 0,
+        out_of_bounds = 1,      // Read past the end of the data
+        malformed     = 2,      // Invalid encoding, like an overlong varint
+        out_of_range  = 3,      // Decoded value doesn't fit the target type
+        size_mismatch = 4,      // Element count differs from a fixed size container
+        misaligned    = 5,      // Span elements not aligned for their type
+        not_viewable  = 6,      // Span elements are varints in a compact buffer
+        over_limit    = 7       // Exceeds the buffer's deserialize limits
     };
 }
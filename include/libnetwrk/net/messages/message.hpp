@@ -5,7 +5,7 @@
 
 #include <chrono>
 
-namespace libnetwrk {
+namespace libnetwrk::inline LIBNETWRK_BUFFER_NAMESPACE {
     template<typename Desc>
     requires libnetwrk_desc<Desc>
     class message {
@@ -27,6 +27,19 @@ namespace libnetwrk {
             set_command(command);
         }
 
+        /*
+            Build the message data in resource. Sending copies it out unless
+            the resource is the default, so the resource may be reset right after.
+        */
+        explicit message(std::pmr::memory_resource* resource)
+            : data(resource) {}
+
+        message(command_t command, std::pmr::memory_resource* resource)
+            : data(resource)
+        {
+            set_command(command);
+        }
+
         message_t& operator=(const message_t&) = default;
         message_t& operator=(message_t&&)      = default;
 
@@ -56,6 +69,9 @@ namespace libnetwrk {
 
         template <typename T>
         message_t& operator<<(const T& value) {
+            // Single allocation for the whole value instead of one per growth step
+            data.reserve_additional(libnetwrk::serialize::serialized_size(value));
+
             data << value;
             head.data_size = (uint32_t)data.size();
             return *this;
@@ -66,5 +82,15 @@ namespace libnetwrk {
             data >> value;
             return *this;
         }
+
+        /*
+            Read without throwing, for untrusted input.
+
+            @returns first error, none on success
+        */
+        template <typename T>
+        [[nodiscard]] deserialize_error try_read(T& value) {
+            return libnetwrk::serialize::try_deserialize(data, value);
+        }
     };
 }
\ No newline at end of file
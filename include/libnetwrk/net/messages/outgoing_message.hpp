@@ -5,7 +5,7 @@
 
 #include <mutex>
 
-namespace libnetwrk {
+namespace libnetwrk::inline LIBNETWRK_BUFFER_NAMESPACE {
     template<typename Desc>
     requires libnetwrk_desc<Desc>
     class outgoing_message {
@@ -21,7 +21,7 @@ namespace libnetwrk {
             : message(message) {}
 
         outgoing_message(message_t&& message)
-            : message(std::move(message)) {}
+            : message(take(message)) {}
 
         outgoing_message& operator=(const outgoing_message&) = delete;
         outgoing_message& operator=(outgoing_message&&)      = delete;
@@ -30,5 +30,17 @@ namespace libnetwrk {
         message_t                                     message;
         fixed_buffer<message_t::message_head_t::size> serialized_head;
         std::mutex                                    mutex;
+
+    private:
+        /*
+            Messages built in another memory resource are copied out,
+            the resource may be reset before the message is written.
+        */
+        static message_t take(message_t& message) {
+            if (message.data.get_memory_resource() == std::pmr::get_default_resource())
+                return std::move(message);
+
+            return message;
+        }
     };
 }
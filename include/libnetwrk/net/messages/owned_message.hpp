@@ -2,7 +2,7 @@
 
 #include "libnetwrk/net/messages/message.hpp"
 
-namespace libnetwrk {
+namespace libnetwrk::inline LIBNETWRK_BUFFER_NAMESPACE {
     template<typename Desc, typename Connection>
     requires libnetwrk_desc<Desc>
     class owned_message {
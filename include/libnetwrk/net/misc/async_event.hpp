@@ -0,0 +1,222 @@
+#pragma once
+
+#include "asio.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace libnetwrk {
+    /*
+        Event for coroutines, safe to notify from any thread.
+
+        A notify without a waiter stays pending and completes the next wait,
+        notifies made while one is already pending are coalesced.
+        Once closed every wait completes right away until reset.
+    */
+    class async_event {
+    public:
+        async_event()                   = delete;
+        async_event(const async_event&) = delete;
+        async_event(async_event&&)      = delete;
+
+        async_event(asio::io_context& context)
+            : m_io_context(context) {}
+
+        async_event& operator=(const async_event&) = delete;
+        async_event& operator=(async_event&&)      = delete;
+
+    public:
+        /*
+            Wait for notify or close.
+
+            @param void() token -> completion handler or token, also completed on cancellation
+        */
+        template<typename CompletionToken>
+        auto async_wait(CompletionToken&& token) {
+            return asio::async_initiate<CompletionToken, void()>(
+                [this](auto handler) {
+                    initiate_wait(std::move(handler));
+                },
+                token
+            );
+        }
+
+        /*
+            Wait for notify or close from a coroutine.
+        */
+        asio::awaitable<void> wait() {
+            // Already signaled, skip the round trip through the io_context
+            if (m_closed || m_pending.exchange(false))
+                co_return;
+
+            co_await async_wait(asio::use_awaitable);
+        }
+
+        /*
+            Wait for all operations to finish or the io context to stop.
+        */
+        void wait_for_end() {
+            // A stopped io context doesn't complete anything, check on it every so often
+            constexpr auto stopped_check_interval = std::chrono::milliseconds(100);
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            while (m_operations != 0 && !m_io_context.stopped())
+                m_end_cv.wait_for(lock, stopped_check_interval);
+        }
+
+        bool has_active_operations() {
+            return m_operations != 0;
+        }
+
+        /*
+            Wake one waiter, or leave a pending signal for the next wait.
+
+            Cheap while a signal is already pending. Publish whatever the waiter
+            should see with a seq_cst write before notifying, the pending check
+            is a plain load.
+        */
+        void notify_one() {
+            if (m_pending.load() || m_pending.exchange(true))
+                return;
+
+            std::lock_guard<std::mutex> guard(m_mutex);
+
+            if (m_waiters.empty())
+                return;
+
+            m_pending = false;
+
+            waiter_t waiter = std::move(m_waiters.front());
+            m_waiters.erase(m_waiters.begin());
+
+            complete(std::move(waiter.handler), waiter.slot);
+        }
+
+        /*
+            Wake all waiters, or leave a pending signal for the next wait.
+        */
+        void notify_all() {
+            if (m_pending.load() || m_pending.exchange(true))
+                return;
+
+            std::lock_guard<std::mutex> guard(m_mutex);
+
+            if (m_waiters.empty())
+                return;
+
+            m_pending = false;
+            complete_all();
+        }
+
+        /*
+            Complete all current and future waits until reset.
+        */
+        void close() {
+            std::lock_guard<std::mutex> guard(m_mutex);
+
+            m_closed = true;
+            complete_all();
+        }
+
+        void reset() {
+            std::lock_guard<std::mutex> guard(m_mutex);
+
+            m_closed  = false;
+            m_pending = false;
+        }
+
+    private:
+        using handler_t = asio::any_completion_handler<void()>;
+
+        struct waiter_t {
+            uint64_t                id;
+            handler_t               handler;
+            asio::cancellation_slot slot;
+        };
+
+    private:
+        asio::io_context&       m_io_context;
+        std::mutex              m_mutex;
+        std::condition_variable m_end_cv;
+        std::vector<waiter_t>   m_waiters;
+        uint64_t                m_last_id    = 0U;
+        std::atomic_bool        m_closed     = false;
+        std::atomic_bool        m_pending    = false;
+        std::atomic_uint16_t    m_operations = 0U;      // Changed under m_mutex
+
+    private:
+        template<typename Handler>
+        void initiate_wait(Handler&& raw_handler) {
+            handler_t handler(std::move(raw_handler));
+
+            std::lock_guard<std::mutex> guard(m_mutex);
+
+            m_operations++;
+
+            if (m_closed || m_pending.exchange(false))
+                return complete(std::move(handler));
+
+            uint64_t id   = ++m_last_id;
+            auto     slot = asio::get_associated_cancellation_slot(handler);
+
+            // The type erased handler forwards cancellation to its own slot
+            if (slot.is_connected()) {
+                slot.assign([this, id](asio::cancellation_type) {
+                    cancel(id);
+                });
+            }
+
+            m_waiters.push_back({ id, std::move(handler), slot });
+        }
+
+        void cancel(uint64_t id) {
+            std::lock_guard<std::mutex> guard(m_mutex);
+
+            for (auto it = m_waiters.begin(); it != m_waiters.end(); it++) {
+                if (it->id != id) continue;
+
+                handler_t handler = std::move(it->handler);
+                m_waiters.erase(it);
+
+                return complete(std::move(handler));
+            }
+        }
+
+        void complete_all() {
+            for (auto& waiter : m_waiters)
+                complete(std::move(waiter.handler), waiter.slot);
+
+            m_waiters.clear();
+        }
+
+        /*
+            Go through the io thread, never inline in the notifying thread,
+            then resume on the executor the handler is bound to.
+            The cancellation handler is detached there too, the slot may be emitted on the io thread.
+            Called with m_mutex held.
+        */
+        void complete(handler_t handler, asio::cancellation_slot slot = {}) {
+            auto executor = asio::get_associated_executor(handler, m_io_context.get_executor());
+
+            asio::post(m_io_context, [this, executor, slot, handler = std::move(handler)]() mutable {
+                if (slot.is_connected())
+                    slot.clear();
+
+                {
+                    // Notify under the lock, wait_for_end may destroy the event as soon as it can take it
+                    std::lock_guard<std::mutex> guard(m_mutex);
+
+                    m_operations--;
+                    m_end_cv.notify_all();
+                }
+
+                asio::dispatch(executor, std::move(handler));
+            });
+        }
+    };
+}
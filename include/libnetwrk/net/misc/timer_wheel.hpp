@@ -0,0 +1,245 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <utility>
+
+namespace libnetwrk {
+    /*
+        Hierarchical timing wheel.
+
+        Time is measured in ticks advanced by the owner. Scheduling and cancelling are O(1),
+        advancing is O(1) per tick plus the timers that expire or cascade down a level.
+        With the defaults (4 levels of 64 slots) timers up to 2^24 ticks ahead are placed
+        exactly, longer ones are parked on the last level and re-placed when reached.
+    */
+    template<typename Payload, uint32_t SlotBits = 6U, uint32_t Levels = 4U>
+    class timer_wheel {
+    public:
+        using payload_t  = Payload;
+        using timer_id_t = uint64_t;
+
+        static constexpr timer_id_t invalid_timer = 0U;
+
+    public:
+        timer_wheel() {
+            m_buckets.fill(npos);
+        }
+
+        timer_wheel(const timer_wheel&) = delete;
+        timer_wheel(timer_wheel&&)      = default;
+
+        timer_wheel& operator=(const timer_wheel&) = delete;
+        timer_wheel& operator=(timer_wheel&&)      = default;
+
+    public:
+        /*
+            Current tick.
+        */
+        uint64_t now() const {
+            return m_now;
+        }
+
+        /*
+            Number of scheduled timers.
+        */
+        size_t size() const {
+            return m_size;
+        }
+
+        /*
+            Schedule a timer to expire after delay ticks, at least 1.
+        */
+        timer_id_t schedule(uint64_t delay, payload_t payload) {
+            uint32_t index = allocate_node();
+            node_t&  node  = m_nodes[index];
+
+            node.expires = m_now + (delay == 0U ? 1U : delay);
+            node.payload = std::move(payload);
+
+            link(index);
+            m_size++;
+
+            return make_id(index, node.generation);
+        }
+
+        /*
+            Cancel a scheduled timer. Returns false if already expired or cancelled.
+        */
+        bool cancel(timer_id_t id) {
+            uint32_t index = 0U;
+            if (!get_node_index(id, index))
+                return false;
+
+            unlink(index);
+            free_node(index);
+            m_size--;
+
+            return true;
+        }
+
+        /*
+            Advance time by ticks and call callback(payload_t&) for every expired timer.
+            Callback may schedule and cancel timers, including ones expiring on the same tick.
+        */
+        template<typename Callback>
+        size_t advance(uint64_t ticks, Callback&& callback) {
+            size_t fired = 0U;
+
+            for (uint64_t i = 0U; i < ticks; i++) {
+                m_now++;
+
+                cascade();
+
+                uint32_t bucket = bucket_index(0U, m_now);
+
+                // Unlink one at a time, the callback may cancel timers still in the bucket
+                while (m_buckets[bucket] != npos) {
+                    uint32_t  index   = m_buckets[bucket];
+                    payload_t payload = std::move(m_nodes[index].payload);
+
+                    unlink(index);
+                    free_node(index);
+                    m_size--;
+                    fired++;
+
+                    callback(payload);
+                }
+            }
+
+            return fired;
+        }
+
+    private:
+        static constexpr uint32_t npos      = static_cast<uint32_t>(-1);
+        static constexpr uint32_t slots     = 1U << SlotBits;
+        static constexpr uint64_t slot_mask = slots - 1U;
+        static constexpr uint64_t max_span  = 1ULL << (SlotBits * Levels);
+
+        struct node_t {
+            uint64_t  expires    = 0U;
+            payload_t payload    = {};
+            uint32_t  prev       = npos;
+            uint32_t  next       = npos;
+            uint32_t  bucket     = npos;     // npos when free
+            uint32_t  generation = 0U;
+        };
+
+    private:
+        std::vector<node_t>                     m_nodes;
+        std::array<uint32_t, slots * Levels>    m_buckets;
+        uint32_t                                m_free_head = npos;
+        uint64_t                                m_now       = 0U;
+        size_t                                  m_size      = 0U;
+
+    private:
+        static timer_id_t make_id(uint32_t index, uint32_t generation) {
+            return (static_cast<timer_id_t>(generation) << 32) | (static_cast<timer_id_t>(index) + 1U);
+        }
+
+        static uint32_t bucket_index(uint32_t level, uint64_t tick) {
+            return level * slots + static_cast<uint32_t>((tick >> (level * SlotBits)) & slot_mask);
+        }
+
+        bool get_node_index(timer_id_t id, uint32_t& out_index) const {
+            uint32_t low = static_cast<uint32_t>(id);
+            if (low == 0U || low > m_nodes.size())
+                return false;
+
+            const node_t& node = m_nodes[low - 1U];
+            if (node.bucket == npos || node.generation != static_cast<uint32_t>(id >> 32))
+                return false;
+
+            out_index = low - 1U;
+            return true;
+        }
+
+        uint32_t allocate_node() {
+            if (m_free_head == npos) {
+                m_nodes.push_back({});
+                return static_cast<uint32_t>(m_nodes.size() - 1);
+            }
+
+            uint32_t index = m_free_head;
+            m_free_head    = m_nodes[index].next;
+            return index;
+        }
+
+        void free_node(uint32_t index) {
+            node_t& node = m_nodes[index];
+
+            node.payload = {};
+            node.bucket  = npos;
+            node.prev    = npos;
+            node.next    = m_free_head;
+            node.generation++;
+
+            m_free_head = index;
+        }
+
+        void link(uint32_t index) {
+            node_t&  node  = m_nodes[index];
+            uint64_t delta = node.expires > m_now ? node.expires - m_now : 0U;
+
+            // Park timers beyond the wheel span on the furthest slot, they get re-placed on cascade
+            uint64_t placed = delta < max_span ? node.expires : m_now + max_span - 1U;
+
+            uint32_t level = 0U;
+            while (level + 1U < Levels && delta >= (1ULL << ((level + 1U) * SlotBits)))
+                level++;
+
+            uint32_t bucket = delta == 0U ? bucket_index(0U, m_now) : bucket_index(level, placed);
+
+            node.bucket = bucket;
+            node.prev   = npos;
+            node.next   = m_buckets[bucket];
+
+            if (node.next != npos)
+                m_nodes[node.next].prev = index;
+
+            m_buckets[bucket] = index;
+        }
+
+        void unlink(uint32_t index) {
+            node_t& node = m_nodes[index];
+
+            if (node.prev != npos) {
+                m_nodes[node.prev].next = node.next;
+            }
+            else {
+                m_buckets[node.bucket] = node.next;
+            }
+
+            if (node.next != npos)
+                m_nodes[node.next].prev = node.prev;
+
+            node.prev = npos;
+            node.next = npos;
+        }
+
+        /*
+            Move timers of higher level slots reached at this tick down the wheel.
+        */
+        void cascade() {
+            uint32_t level = 1U;
+
+            while (level < Levels && ((m_now >> ((level - 1U) * SlotBits)) & slot_mask) == 0U)
+                level++;
+
+            // Levels [1, level) wrapped, cascade from the highest one down
+            for (uint32_t l = level - 1U; l >= 1U; l--) {
+                uint32_t bucket = bucket_index(l, m_now);
+                uint32_t index  = m_buckets[bucket];
+                m_buckets[bucket] = npos;
+
+                while (index != npos) {
+                    uint32_t next = m_nodes[index].next;
+                    link(index);
+                    index = next;
+                }
+            }
+        }
+    };
+}
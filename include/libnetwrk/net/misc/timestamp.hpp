@@ -7,6 +7,7 @@
 #endif
 
 #include <cstdint>
+#include <chrono>
 
 namespace libnetwrk {
     /*
@@ -32,4 +33,20 @@ namespace libnetwrk {
         return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
     #endif
     }
+
+    /*
+        Get a monotonic ms timestamp, only meaningful relative to other monotonic timestamps
+    */
+    inline uint64_t get_steady_milliseconds_timestamp() {
+        auto since_epoch = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(since_epoch).count());
+    }
+
+    /*
+        Get a monotonic us timestamp, only meaningful relative to other monotonic timestamps
+    */
+    inline uint64_t get_steady_microseconds_timestamp() {
+        auto since_epoch = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(since_epoch).count());
+    }
 }
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "libnetwrk/net/misc/timestamp.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+namespace libnetwrk {
+    /*
+        Token bucket rate limiter.
+
+        Refills at rate tokens per second up to burst tokens. A rate of 0 disables limiting.
+        Taking more than burst tokens at once is allowed from a full bucket and leaves
+        it in debt, so oversized requests still pass at the average rate.
+        Not thread safe.
+    */
+    class token_bucket {
+    public:
+        token_bucket() = default;
+
+        token_bucket(double rate, double burst) {
+            reset(rate, burst);
+        }
+
+    public:
+        void reset(double rate, double burst) {
+            m_rate        = rate;
+            m_burst       = std::max(burst, 1.0);
+            m_tokens      = m_burst;
+            m_last_refill = get_steady_microseconds_timestamp();
+        }
+
+        bool is_limited() const {
+            return m_rate > 0.0;
+        }
+
+        /*
+            Check if tokens could be taken now.
+        */
+        bool can_consume(double tokens = 1.0) {
+            if (!is_limited())
+                return true;
+
+            refill();
+            return m_tokens >= std::min(tokens, m_burst);
+        }
+
+        /*
+            Take tokens if available.
+        */
+        bool try_consume(double tokens = 1.0) {
+            if (!can_consume(tokens))
+                return false;
+
+            if (is_limited())
+                m_tokens -= tokens;
+
+            return true;
+        }
+
+        /*
+            Take tokens even if it puts the bucket in debt, at most max_debt_sec worth of refill.
+            Returns microseconds until the debt is paid off, 0 if not in debt.
+        */
+        uint64_t consume(double tokens = 1.0, double max_debt_sec = std::numeric_limits<double>::infinity()) {
+            if (!is_limited())
+                return 0U;
+
+            refill();
+            m_tokens = std::max(m_tokens - tokens, -m_rate * max_debt_sec);
+
+            if (m_tokens >= 0.0)
+                return 0U;
+
+            return static_cast<uint64_t>(-m_tokens / m_rate * 1000000.0);
+        }
+
+    private:
+        double   m_rate        = 0.0;
+        double   m_burst       = 1.0;
+        double   m_tokens      = 1.0;
+        uint64_t m_last_refill = 0U;
+
+    private:
+        void refill() {
+            uint64_t now = get_steady_microseconds_timestamp();
+
+            if (now <= m_last_refill)
+                return;
+
+            m_tokens      = std::min(m_burst, m_tokens + (now - m_last_refill) * m_rate / 1000000.0);
+            m_last_refill = now;
+        }
+    };
+}
@@ -2,14 +2,61 @@
 
 #include "libnetwrk/net/serialize/serialize_internal.hpp"
 
+#include <utility>
+
 namespace libnetwrk::serialize {
-    template<typename Buffer, typename Type>
+    template<is_buffer Buffer, typename Type>
     inline void serialize(Buffer& buffer, const Type& value) {
         libnetwrk::serialize::internal::serialize(buffer, value);
     }
 
-    template<typename Buffer, typename Type>
+    template<typename Type>
+    inline constexpr size_t serialized_size(const Type& value) {
+        return libnetwrk::serialize::internal::serialized_size(value);
+    }
+
+    template<is_buffer Buffer, typename Type>
     inline void deserialize(Buffer& buffer, Type& obj) {
-        libnetwrk::serialize::internal::deserialize(buffer, obj);
+        auto state = libnetwrk::serialize::internal::make_decode_state(buffer, true);
+        auto outer = get_buffer_decode_state(buffer);
+
+        // Called by a user type from inside another call, join it
+        auto& current = outer ? *outer : state;
+
+        libnetwrk::serialize::internal::deserialize(buffer, obj, current);
+        libnetwrk::serialize::internal::throw_if_failed(current);
+    }
+
+    /*
+        Deserialize without throwing on malformed or truncated data, for untrusted input.
+        On error obj keeps what was read before the failure, a primitive is left untouched.
+        The read position is unspecified.
+
+        @returns first error, none on success
+    */
+    template<is_buffer Buffer, typename Type>
+    [[nodiscard]] inline deserialize_error try_deserialize(Buffer& buffer, Type& obj) {
+        struct throws_guard {
+            bool& throws;
+            bool  previous;
+
+            ~throws_guard() {
+                throws = previous;
+            }
+        };
+
+        if (auto outer = get_buffer_decode_state(buffer)) {
+            throws_guard guard{ outer->throws, outer->throws };
+
+            outer->throws = false;
+            libnetwrk::serialize::internal::deserialize(buffer, obj, *outer);
+
+            return std::exchange(outer->error, deserialize_error::none);
+        }
+
+        auto state = libnetwrk::serialize::internal::make_decode_state(buffer, false);
+
+        libnetwrk::serialize::internal::deserialize(buffer, obj, state);
+        return state.error;
     }
 }
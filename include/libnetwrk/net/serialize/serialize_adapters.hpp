@@ -2,45 +2,198 @@
 
 #include "libnetwrk/net/containers/fixed_buffer.hpp"
 #include "libnetwrk/net/containers/dynamic_buffer.hpp"
+#include "libnetwrk/net/serialize/serialize_varint.hpp"
 #include "libnetwrk/exceptions/libnetwrk_exception.hpp"
 
 #include <cstring>
+#include <utility>
 
 namespace libnetwrk::serialize::internal {
+    ////////////////////////////////////////////////////////////////////////////
+    // ERRORS
+
+    inline constexpr deserialize_limits no_deserialize_limits = {};
+
+    /*
+        State for a deserialize call. Only received messages carry limits.
+    */
+    template<typename Buffer>
+    inline decode_state make_decode_state(Buffer& buffer, bool throws) {
+        decode_state state;
+        state.throws = throws;
+
+        if constexpr (requires { buffer.get_deserialize_limits(); })
+            state.limits = &buffer.get_deserialize_limits();
+        else
+            state.limits = &no_deserialize_limits;
+
+        return state;
+    }
+
+    /*
+        Point the buffer at the call's state while a user type deserializes itself,
+        the calls it makes through >> find it there. Plain values never need it.
+    */
+    class decode_state_guard {
+    public:
+        decode_state_guard(buffer& buffer, decode_state& state)
+            : m_active(get_buffer_decode_state(buffer)), m_outer(std::exchange(m_active, &state)) {}
+
+        decode_state_guard(const decode_state_guard&)            = delete;
+        decode_state_guard& operator=(const decode_state_guard&) = delete;
+
+        ~decode_state_guard() {
+            m_active = m_outer;
+        }
+
+    private:
+        decode_state*& m_active;
+        decode_state*  m_outer;
+    };
+
+    /*
+        Record the first deserialize error. A failed primitive read leaves its destination untouched,
+        containers and user types keep what was read before the failure.
+
+        @returns false
+    */
+    inline bool fail(decode_state& state, deserialize_error error) {
+        if (state.error == deserialize_error::none)
+            state.error = error;
+
+        return false;
+    }
+
+    inline bool failed(const decode_state& state) {
+        return state.error != deserialize_error::none;
+    }
+
+    inline const char* error_message(deserialize_error error) {
+        switch (error) {
+            case deserialize_error::out_of_bounds: return "deserialize: tried to read outside bounds.";
+            case deserialize_error::malformed:     return "deserialize: malformed data.";
+            case deserialize_error::out_of_range:  return "deserialize: value out of range.";
+            case deserialize_error::size_mismatch: return "deserialize: std::array size not the same.";
+            case deserialize_error::misaligned:    return "deserialize: span elements not aligned.";
+            case deserialize_error::not_viewable:  return "deserialize: compact buffer elements can't be viewed.";
+            case deserialize_error::over_limit:    return "deserialize: size exceeds limits.";
+            default:                               return "deserialize: failed.";
+        }
+    }
+
+    /*
+        Throw the recorded error, unless inside try_deserialize.
+    */
+    [[noreturn]] inline void throw_error(decode_state& state) {
+        throw libnetwrk_exception(error_message(std::exchange(state.error, deserialize_error::none)));
+    }
+
+    inline void throw_if_failed(decode_state& state) {
+        // Every user type field passes here, keep the throw out of line
+        if (failed(state) && state.throws) [[unlikely]]
+            throw_error(state);
+    }
+
+    /*
+        Move past a decoded varint.
+
+        @param available -> bytes that were left to decode from
+        @param size      -> bytes decoded, 0 if decoding failed
+    */
+    inline bool advance_varint(uint32_t& read_index, uint32_t available, uint32_t size, decode_state& state) {
+        // Only a complete 10 byte varint can be malformed, shorter input ran out
+        if (size == 0U)
+            return fail(state, available < max_varint_size ? deserialize_error::out_of_bounds : deserialize_error::malformed);
+
+        read_index += size;
+        return true;
+    }
+
     ////////////////////////////////////////////////////////////////////////////
     // DYNAMIC BUFFER
 
-    inline void read(dynamic_buffer& buffer, uint8_t* destination, uint32_t size) {
+    inline uint32_t written(dynamic_buffer& buffer) {
+        return buffer.size();
+    }
+
+    inline uint32_t remaining(dynamic_buffer& buffer) {
+        return buffer.size() - get_buffer_read_index(buffer);
+    }
+
+    inline bool read(dynamic_buffer& buffer, uint8_t* destination, uint32_t size, decode_state& state) {
         auto& underlying = buffer.underlying();
         auto& read_index = get_buffer_read_index(buffer);
 
-        if (read_index + size > underlying.size())
-            throw libnetwrk_exception("dynamic_buffer: tried to read outside bounds.");
+        if (size > underlying.size() - read_index)
+            return fail(state, deserialize_error::out_of_bounds);
 
-        std::memcpy(destination, underlying.data() + read_index, size);
+        copy_bytes(destination, underlying.data() + read_index, size);
         read_index += size;
+        return true;
     }
 
     inline void write(dynamic_buffer& buffer, const uint8_t* data, uint32_t size) {
+    #ifdef LIBNETWRK_POISON_VIEWS
+        // Grow through the buffer, so views into the old storage are poisoned
+        buffer.reserve_additional(size);
+    #endif
+
+        buffer.underlying().append(data, size);
+    }
+
+    /*
+        Take the next size bytes without copying. The result aliases the buffer.
+    */
+    inline const uint8_t* borrow(dynamic_buffer& buffer, uint32_t size, decode_state& state) {
         auto& underlying = buffer.underlying();
+        auto& read_index = get_buffer_read_index(buffer);
+
+        if (size > underlying.size() - read_index)
+            return fail(state, deserialize_error::out_of_bounds), nullptr;
 
-        underlying.insert(underlying.end(), data, data + size);
+        // Views must follow the data when the buffer moves, inline bytes stay behind
+        underlying.spill();
+
+        const uint8_t* data = underlying.data() + read_index;
+        read_index += size;
+
+        get_buffer_lent(buffer) = true;
+        return data;
+    }
+
+    inline bool read_varint(dynamic_buffer& buffer, uint64_t& encoded, decode_state& state) {
+        auto& read_index = get_buffer_read_index(buffer);
+
+        uint32_t available = buffer.size() - read_index;
+
+        return advance_varint(read_index, available, decode_varint(buffer.data() + read_index, available, encoded), state);
     }
 
     ////////////////////////////////////////////////////////////////////////////
     // FIXED BUFFER
 
     template<uint32_t Size>
-    inline void read(fixed_buffer<Size>& buffer, uint8_t* destination, uint32_t size) {
+    inline uint32_t written(fixed_buffer<Size>& buffer) {
+        return get_buffer_write_index(buffer);
+    }
+
+    template<uint32_t Size>
+    inline uint32_t remaining(fixed_buffer<Size>& buffer) {
+        return get_buffer_write_index(buffer) - get_buffer_read_index(buffer);
+    }
+
+    template<uint32_t Size>
+    inline bool read(fixed_buffer<Size>& buffer, uint8_t* destination, uint32_t size, decode_state& state) {
         auto& underlying  = buffer.underlying();
         auto& write_index = get_buffer_write_index(buffer);
         auto& read_index  = get_buffer_read_index(buffer);
 
-        if (read_index + size > write_index)
-            throw libnetwrk_exception("fixed_buffer: tried to read outside bounds.");
+        if (size > write_index - read_index)
+            return fail(state, deserialize_error::out_of_bounds);
 
-        std::memcpy(destination, underlying.data() + read_index, size);
+        copy_bytes(destination, underlying.data() + read_index, size);
         read_index += size;
+        return true;
     }
 
     template<uint32_t Size>
@@ -51,7 +204,74 @@ namespace libnetwrk::serialize::internal {
         if (write_index + size > underlying.size())
             throw libnetwrk_exception("fixed_buffer: tried to write outside bounds.");
 
-        std::memcpy(underlying.data() + write_index, data, size);
+        copy_bytes(underlying.data() + write_index, data, size);
         write_index += size;
     }
+
+    template<uint32_t Size>
+    inline const uint8_t* borrow(fixed_buffer<Size>& buffer, uint32_t size, decode_state& state) {
+        auto& underlying  = buffer.underlying();
+        auto& write_index = get_buffer_write_index(buffer);
+        auto& read_index  = get_buffer_read_index(buffer);
+
+        if (size > write_index - read_index)
+            return fail(state, deserialize_error::out_of_bounds), nullptr;
+
+        const uint8_t* data = underlying.data() + read_index;
+        read_index += size;
+
+        return data;
+    }
+
+    template<uint32_t Size>
+    inline bool read_varint(fixed_buffer<Size>& buffer, uint64_t& encoded, decode_state& state) {
+        auto& write_index = get_buffer_write_index(buffer);
+        auto& read_index  = get_buffer_read_index(buffer);
+
+        uint32_t available = write_index - read_index;
+
+        return advance_varint(read_index, available, decode_varint(buffer.data() + read_index, available, encoded), state);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    // ANY BUFFER
+
+    template<typename Buffer>
+    inline void write_varint(Buffer& buffer, uint64_t encoded) {
+        uint8_t  bytes[max_varint_size];
+        uint32_t size = encode_varint(encoded, bytes);
+
+        write(buffer, bytes, size);
+    }
+
+    /*
+        Check a length prefix read from the buffer before allocating for it.
+
+        @param count     -> elements the prefix claims
+        @param min_size  -> fewest bytes one element takes in the buffer
+        @param footprint -> bytes one element allocates, 0 if it's stored in place
+    */
+    template<typename Buffer>
+    inline bool accept_length(Buffer& buffer, uint32_t count, uint32_t min_size, uint32_t footprint, decode_state& state) {
+        const auto& limits = *state.limits;
+
+        if (static_cast<uint64_t>(count) * min_size > remaining(buffer))
+            return fail(state, deserialize_error::out_of_bounds);
+
+        if (limits.max_elements != 0U && count > limits.max_elements)
+            return fail(state, deserialize_error::over_limit);
+
+        if (footprint == 0U)
+            return true;
+
+        state.allocated += static_cast<uint64_t>(count) * footprint;
+
+        if (limits.max_allocation != 0U && state.allocated > limits.max_allocation)
+            return fail(state, deserialize_error::over_limit);
+
+        if (limits.max_allocation_ratio != 0U && state.allocated > static_cast<uint64_t>(limits.max_allocation_ratio) * written(buffer))
+            return fail(state, deserialize_error::over_limit);
+
+        return true;
+    }
 }
\ No newline at end of file
@@ -14,6 +14,8 @@
 #include <unordered_set>
 #include <map>
 #include <unordered_map>
+#include <span>
+#include <string_view>
 
 namespace {
     template <typename...>
@@ -26,7 +28,7 @@ namespace {
     };
 
     template<typename Buffer>
-    concept supported_buffer = std::derived_from<Buffer, libnetwrk::buffer>;
+    concept supported_buffer = libnetwrk::is_buffer<Buffer>;
 
     ////////////////////////////////////////////////////////////////////////////
     // SUPPORTED
@@ -60,6 +62,62 @@ namespace {
         };
     };
 
+    // Unique object representations rule out padding, declared member sizes cover floating point members
+    template<typename Type>
+    concept padding_free = requires {
+        requires std::has_unique_object_representations_v<Type> ||
+                 libnetwrk::serialize_as_bytes_size<Type> == sizeof(Type);
+    };
+
+    // Raw bytes are the wire format on little endian systems only
+    template<typename Type>
+    concept bytes_serialize = requires {
+        requires libnetwrk::serialize_as_bytes<Type> &&
+                 std::is_trivially_copyable_v<Type>  &&
+                 std::is_standard_layout_v<Type>     &&
+                 padding_free<Type>                  &&
+                 is_system_little_endian();
+    };
+
+    /*
+        Elements a contiguous container can copy with a single memcpy.
+    */
+    template<typename Type>
+    concept memcpy_element = requires {
+        requires (primitive<Type> && !libnetwrk::serialize::internal::enforce_endianness<Type>) ||
+                 bytes_serialize<Type>;
+    };
+
+    /*
+        Read only span over elements that can alias the buffer.
+    */
+    template<typename Type>
+    concept span_view = requires {
+        requires std::same_as<Type, std::span<typename Type::element_type>> &&
+                 std::is_const_v<typename Type::element_type>                &&
+                 memcpy_element<std::remove_const_t<typename Type::element_type>>;
+    };
+
+    /*
+        Span views that can be read. Elements follow a 4 byte length prefix,
+        so wider alignments would only line up by chance. Read those into a vector.
+    */
+    template<typename Type>
+    concept readable_span_view = requires {
+        requires span_view<Type> &&
+                 alignof(typename Type::element_type) <= alignof(uint32_t);
+    };
+
+    template<typename Type>
+    concept user_defined_min_serialized_size = requires {
+        { Type::min_serialized_size } -> convertible_to<uint32_t>;
+    };
+
+    template<typename Type>
+    concept user_defined_serialized_size = requires(const Type value) {
+        { value.serialized_size() } -> convertible_to<size_t>;
+    };
+
     template<typename Type>
     concept is_std_array = requires {
         requires (
@@ -69,10 +127,44 @@ namespace {
         );
     };
 
+    /*
+        Standard strings and containers with any allocator, like the std::pmr ones.
+    */
+    template<typename Type>
+    concept is_string = requires {
+        requires std::same_as<Type, std::basic_string<char, std::char_traits<char>, typename Type::allocator_type>>;
+    };
+
+    template<typename Type>
+    concept is_vector = requires {
+        requires std::same_as<Type, std::vector<typename Type::value_type, typename Type::allocator_type>>;
+    };
+
+    template<typename Type>
+    concept is_sequence = requires {
+        requires std::same_as<Type, std::deque<typename Type::value_type, typename Type::allocator_type>> ||
+                 std::same_as<Type, std::list<typename Type::value_type, typename Type::allocator_type>>;
+    };
+
+    template<typename Type>
+    concept is_set = requires {
+        requires std::same_as<Type, std::set<typename Type::key_type, typename Type::key_compare, typename Type::allocator_type>> ||
+                 std::same_as<Type, std::unordered_set<typename Type::key_type, typename Type::hasher,
+                                                       typename Type::key_equal, typename Type::allocator_type>>;
+    };
+
+    template<typename Type>
+    concept is_map = requires {
+        requires std::same_as<Type, std::map<typename Type::key_type, typename Type::mapped_type,
+                                             typename Type::key_compare, typename Type::allocator_type>> ||
+                 std::same_as<Type, std::unordered_map<typename Type::key_type, typename Type::mapped_type, typename Type::hasher,
+                                                       typename Type::key_equal, typename Type::allocator_type>>;
+    };
+
     template<typename Type>
     concept contiguous_containers = requires {
         requires ( 
-            std::same_as<Type, std::vector<typename Type::value_type>> && 
+            is_vector<Type> && 
             !std::same_as<typename Type::value_type, bool> 
         ) 
         || is_std_array<Type>;
@@ -80,17 +172,14 @@ namespace {
 
     template<typename Type>
     concept containers = requires {
-        requires contiguous_containers<Type>                               ||
-                 std::same_as<Type, std::deque<typename Type::value_type>> ||
-                 std::same_as<Type, std::list<typename Type::value_type>>  ||
-                 std::same_as<Type, std::set<typename Type::value_type>>   ||
-                 std::same_as<Type, std::unordered_set<typename Type::value_type>>;
+        requires contiguous_containers<Type> ||
+                 is_sequence<Type>           ||
+                 is_set<Type>;
     };
 
     template<typename Type>
     concept kvp_containers = requires {
-        requires std::same_as<Type, std::map<typename Type::key_type, typename Type::mapped_type>> ||
-                 std::same_as<Type, std::unordered_map<typename Type::key_type, typename Type::mapped_type>>;
+        requires is_map<Type>;
     };
 
     ////////////////////////////////////////////////////////////////////////////
@@ -105,15 +194,32 @@ namespace libnetwrk::serialize::internal {
     concept serialize_supported = requires {
         requires primitive<Type>                      ||
                  user_defined_serialize<Buffer, Type> ||
+                 bytes_serialize<Type>                ||
                  containers<Type>                     ||
                  kvp_containers<Type>                 ||
-                 std::same_as<Type, std::string>      || 
+                 is_varint<Type>                      ||
+                 span_view<Type>                      ||
+                 is_string<Type>                      ||
+                 std::same_as<Type, std::string_view> || 
                  std::same_as<Type, char*>;
     };
 
     template<typename Buffer, typename Type>
     concept serialize_unsupported = !serialize_supported<Buffer, Type>;
 
+    /*
+        Check if the type is written as a varint to the buffer.
+    */
+    template<typename Type, typename Buffer>
+    inline bool uses_varint(const Buffer& buffer) {
+        if constexpr (compact_integer<Type>) {
+            return buffer.is_compact();
+        }
+        else {
+            return false;
+        }
+    }
+
     ////////////////////////////////////////////////////////////////////////////
     // UNSUPPORTED
 
@@ -125,7 +231,7 @@ namespace libnetwrk::serialize::internal {
 
     template<typename Buffer, typename Type>
     requires serialize_unsupported<Buffer, Type>
-    inline void deserialize(Buffer& buffer, Type& value) {
+    inline void deserialize(Buffer& buffer, Type& value, decode_state& state) {
         static_assert(assert_force_false<Type>, "Called deserialize() or >> on a buffer with an unsupported type as the arg.");
     }
 
@@ -135,7 +241,11 @@ namespace libnetwrk::serialize::internal {
     template<typename Buffer, typename Type>
     requires primitive<Type>
     inline void serialize(Buffer& buffer, const Type& value) {
-        if constexpr (enforce_endianness<Type>) {
+        // Compact buffers are opt-in, keeps the fixed width path small enough to inline
+        if (uses_varint<Type>(buffer)) [[unlikely]] {
+            internal::write_varint(buffer, internal::to_varint(value));
+        }
+        else if constexpr (enforce_endianness<Type>) {
             Type le = value;
             internal::byte_swap(le);
             internal::write(buffer, static_cast<const uint8_t*>(static_cast<const void*>(&le)), sizeof(Type));
@@ -151,8 +261,32 @@ namespace libnetwrk::serialize::internal {
         value.serialize(buffer);
     }
 
+    template<typename Buffer, typename Type>
+    requires bytes_serialize<Type>
+    inline void serialize(Buffer& buffer, const Type& value) {
+        internal::write(buffer, static_cast<const uint8_t*>(static_cast<const void*>(&value)), sizeof(Type));
+    }
+
+    template<typename Buffer, typename Type>
+    requires is_varint<Type>
+    inline void serialize(Buffer& buffer, const Type& value) {
+        internal::write_varint(buffer, internal::to_varint(value.value));
+    }
+
+    template<typename Buffer, typename Type>
+    requires is_string<Type>
+    inline void serialize(Buffer& buffer, const Type& value) {
+        uint32_t size = static_cast<uint32_t>(value.size());
+
+        if (size != value.size())
+            throw libnetwrk_exception("serialize: size truncated.");
+
+        serialize(buffer, size);
+        internal::write(buffer, static_cast<const uint8_t*>(static_cast<const void*>(value.data())), size);
+    }
+
     template<typename Buffer>
-    inline void serialize(Buffer& buffer, const std::string& value) {
+    inline void serialize(Buffer& buffer, const std::string_view& value) {
         uint32_t size = static_cast<uint32_t>(value.size());
 
         if (size != value.size())
@@ -181,21 +315,44 @@ namespace libnetwrk::serialize::internal {
         serialize(buffer, size);
 
         constexpr auto use_memcpy = (
-            contiguous_containers<Type>          && 
-            primitive<typename Type::value_type> && 
-            !enforce_endianness<typename Type::value_type>
+            contiguous_containers<Type> &&
+            memcpy_element<typename Type::value_type>
         );
 
         if constexpr (use_memcpy) {
-            internal::write(buffer,
-                            static_cast<const uint8_t*>(static_cast<const void*>(value.data())),
-                            size * sizeof(typename Type::value_type));
-        }
-        else {
-            for (auto& element : value) {
-                serialize(buffer, element);
+            if (!uses_varint<typename Type::value_type>(buffer)) {
+                internal::write(buffer,
+                                static_cast<const uint8_t*>(static_cast<const void*>(value.data())),
+                                size * sizeof(typename Type::value_type));
+                return;
             }
         }
+
+        for (auto& element : value) {
+            serialize(buffer, element);
+        }
+    }
+
+    template<typename Buffer, typename Type>
+    requires span_view<Type>
+    inline void serialize(Buffer& buffer, const Type& value) {
+        using element_t = std::remove_const_t<typename Type::element_type>;
+
+        uint32_t size = static_cast<uint32_t>(value.size());
+
+        if (size != value.size())
+            throw libnetwrk_exception("serialize: size truncated.");
+
+        serialize(buffer, size);
+
+        if (!uses_varint<element_t>(buffer)) {
+            internal::write(buffer, static_cast<const uint8_t*>(static_cast<const void*>(value.data())), size * sizeof(element_t));
+            return;
+        }
+
+        for (auto& element : value) {
+            serialize(buffer, element);
+        }
     }
 
     template<typename Buffer, typename Type>
@@ -214,13 +371,130 @@ namespace libnetwrk::serialize::internal {
         }
     }
 
+    ////////////////////////////////////////////////////////////////////////////
+    // SERIALIZED SIZE
+
+    /*
+        Serialized size of every value of the type, 0 if it depends on the value.
+    */
+    template<typename Type>
+    inline constexpr size_t fixed_serialized_size = 0U;
+
+    template<typename Type>
+    requires primitive<Type> || bytes_serialize<Type>
+    inline constexpr size_t fixed_serialized_size<Type> = sizeof(Type);
+
+    template<typename Type>
+    requires is_std_array<Type> && (fixed_serialized_size<typename Type::value_type> != 0U)
+    inline constexpr size_t fixed_serialized_size<Type> =
+        sizeof(uint32_t) + std::tuple_size<Type>::value * fixed_serialized_size<typename Type::value_type>;
+
+    /*
+        Get the number of bytes serialize() writes for the value.
+        User types without a serialized_size() member count as 0, so the result is a lower bound for them.
+        Sizes are for the default encoding, only an estimate for compact buffers.
+    */
+    template<typename Type>
+    inline constexpr size_t serialized_size(const Type& value) {
+        if constexpr (fixed_serialized_size<Type> != 0U) {
+            return fixed_serialized_size<Type>;
+        }
+        else if constexpr (user_defined_serialized_size<Type>) {
+            return static_cast<size_t>(value.serialized_size());
+        }
+        else if constexpr (is_varint<Type>) {
+            return varint_size(to_varint(value.value));
+        }
+        else if constexpr (is_string<Type> || std::same_as<Type, std::string_view>) {
+            return sizeof(uint32_t) + value.size();
+        }
+        else if constexpr (span_view<Type>) {
+            return sizeof(uint32_t) + value.size_bytes();
+        }
+        else if constexpr (std::is_convertible_v<const Type&, const char*>) {
+            return sizeof(uint32_t) + std::char_traits<char>::length(value);
+        }
+        else if constexpr (containers<Type>) {
+            using value_t = typename Type::value_type;
+
+            if constexpr (fixed_serialized_size<value_t> != 0U) {
+                return sizeof(uint32_t) + value.size() * fixed_serialized_size<value_t>;
+            }
+            else {
+                size_t size = sizeof(uint32_t);
+
+                for (auto& element : value)
+                    size += serialized_size(element);
+
+                return size;
+            }
+        }
+        else if constexpr (kvp_containers<Type>) {
+            size_t size = sizeof(uint32_t);
+
+            for (auto& [kvp_key, kvp_value] : value)
+                size += serialized_size(kvp_key) + serialized_size(kvp_value);
+
+            return size;
+        }
+        else {
+            return 0U;
+        }
+    }
+
+    /*
+        Get the fewest bytes a value of the type takes in the buffer.
+        Bounds how many elements a length prefix can claim.
+
+        User types count as at least 1 byte unless they declare
+        static constexpr uint32_t min_serialized_size, 0 leaves only the deserialize limits.
+    */
+    template<typename Type, typename Buffer>
+    inline uint32_t min_serialized_size(const Buffer& buffer) {
+        uint32_t prefix = buffer.is_compact() ? 1U : sizeof(uint32_t);
+
+        if constexpr (primitive<Type> || bytes_serialize<Type>) {
+            return uses_varint<Type>(buffer) ? 1U : sizeof(Type);
+        }
+        else if constexpr (is_varint<Type>) {
+            return 1U;
+        }
+        else if constexpr (is_std_array<Type>) {
+            return prefix + std::tuple_size<Type>::value * min_serialized_size<typename Type::value_type>(buffer);
+        }
+        else if constexpr (containers<Type>                     ||
+                           kvp_containers<Type>                 ||
+                           span_view<Type>                      ||
+                           is_string<Type>                      ||
+                           std::same_as<Type, std::string_view>)
+        {
+            return prefix;
+        }
+        else if constexpr (user_defined_min_serialized_size<Type>) {
+            return static_cast<uint32_t>(Type::min_serialized_size);
+        }
+        else {
+            return 1U;
+        }
+    }
+
     ////////////////////////////////////////////////////////////////////////////
     // DESERIALIZE
     
     template<typename Buffer, typename Type>
     requires primitive<Type>
-    inline void deserialize(Buffer& buffer, Type& value) {
-        internal::read(buffer, static_cast<uint8_t*>(static_cast<void*>(&value)), sizeof(Type));
+    inline void deserialize(Buffer& buffer, Type& value, decode_state& state) {
+        if (uses_varint<Type>(buffer)) [[unlikely]] {
+            uint64_t encoded = 0U;
+
+            if (internal::read_varint(buffer, encoded, state) && !internal::from_varint(encoded, value))
+                internal::fail(state, deserialize_error::out_of_range);
+
+            return;
+        }
+
+        if (!internal::read(buffer, static_cast<uint8_t*>(static_cast<void*>(&value)), sizeof(Type), state))
+            return;
 
         if constexpr (enforce_endianness<Type>) {
             internal::byte_swap(value);
@@ -229,80 +503,176 @@ namespace libnetwrk::serialize::internal {
 
     template<typename Buffer, typename Type>
     requires user_defined_serialize<Buffer, Type>
-    inline void deserialize(Buffer& buffer, Type& value) {
+    inline void deserialize(Buffer& buffer, Type& value, decode_state& state) {
+        // What the type reads through >> joins this call
+        decode_state_guard guard(buffer, state);
         value.deserialize(buffer);
     }
 
-    template<typename Buffer>
-    inline void deserialize(Buffer& buffer, std::string& value) {
+    template<typename Buffer, typename Type>
+    requires bytes_serialize<Type>
+    inline void deserialize(Buffer& buffer, Type& value, decode_state& state) {
+        internal::read(buffer, static_cast<uint8_t*>(static_cast<void*>(&value)), sizeof(Type), state);
+    }
+
+    template<typename Buffer, typename Type>
+    requires is_varint<Type>
+    inline void deserialize(Buffer& buffer, Type& value, decode_state& state) {
+        uint64_t encoded = 0U;
+
+        if (internal::read_varint(buffer, encoded, state) && !internal::from_varint(encoded, value.value))
+            internal::fail(state, deserialize_error::out_of_range);
+    }
+
+    template<typename Buffer, typename Type>
+    requires is_string<Type>
+    inline void deserialize(Buffer& buffer, Type& value, decode_state& state) {
         uint32_t size = 0;
-        deserialize(buffer, size);
-        
+        deserialize(buffer, size, state);
+
+        if (!internal::accept_length(buffer, size, 1U, 1U, state))
+            return;
+
         value.resize(size);
-        internal::read(buffer, static_cast<uint8_t*>(static_cast<void*>(value.data())), size);
+        internal::read(buffer, static_cast<uint8_t*>(static_cast<void*>(value.data())), size, state);
+    }
+
+    /*
+        View the string in place. The view is valid while the buffer is alive and not written to.
+    */
+    template<typename Buffer>
+    inline void deserialize(Buffer& buffer, std::string_view& value, decode_state& state) {
+        uint32_t size = 0;
+        deserialize(buffer, size, state);
+
+        const uint8_t* data = internal::accept_length(buffer, size, 1U, 0U, state) ? internal::borrow(buffer, size, state) : nullptr;
+
+        if (!data) {
+            value = {};
+            return;
+        }
+
+        value = std::string_view(static_cast<const char*>(static_cast<const void*>(data)), size);
+    }
+
+    template<typename Buffer, typename Type>
+    requires span_view<Type> && (!readable_span_view<Type>)
+    inline void deserialize(Buffer& buffer, Type& value, decode_state& state) {
+        static_assert(assert_force_false<Type>, "Span views of elements aligned to more than 4 bytes can't be read, read them into a vector.");
+    }
+
+    /*
+        View the elements in place. The view is valid while the buffer is alive and not written to.
+        Fails if the elements are not aligned for their type in the buffer, like after an odd sized value.
+    */
+    template<typename Buffer, typename Type>
+    requires readable_span_view<Type>
+    inline void deserialize(Buffer& buffer, Type& value, decode_state& state) {
+        using element_t = std::remove_const_t<typename Type::element_type>;
+
+        uint32_t size = 0;
+        deserialize(buffer, size, state);
+
+        value = {};
+
+        if (uses_varint<element_t>(buffer)) {
+            internal::fail(state, deserialize_error::not_viewable);
+            return;
+        }
+
+        if (!internal::accept_length(buffer, size, sizeof(element_t), 0U, state))
+            return;
+
+        const uint8_t* data = internal::borrow(buffer, size * static_cast<uint32_t>(sizeof(element_t)), state);
+
+        if (!data)
+            return;
+
+        if (reinterpret_cast<uintptr_t>(data) % alignof(element_t) != 0U) {
+            internal::fail(state, deserialize_error::misaligned);
+            return;
+        }
+
+        value = Type(static_cast<const element_t*>(static_cast<const void*>(data)), size);
     }
 
     template<typename Buffer, typename Type>
     requires containers<Type>
-    inline void deserialize(Buffer& buffer, Type& value) {
+    inline void deserialize(Buffer& buffer, Type& value, decode_state& state) {
         uint32_t size = 0;
-        deserialize(buffer, size);
+        deserialize(buffer, size, state);
 
         if constexpr (is_std_array<Type>) {
-            if (size != value.size())
-                throw libnetwrk_exception("deserialize: std::array size not the same.");
-        }
-        else if constexpr (std::same_as<Type, std::vector<typename Type::value_type>>) {
-            value.resize(size);
+            if (size != value.size()) {
+                internal::fail(state, deserialize_error::size_mismatch);
+                return;
+            }
         }
         else {
-            value.clear();
+            using value_t = typename Type::value_type;
+
+            // Validated before resizing, a short message can't claim gigabytes
+            if (!internal::accept_length(buffer, size, min_serialized_size<value_t>(buffer), sizeof(value_t), state))
+                return;
+
+            if constexpr (is_vector<Type>) {
+                value.resize(size);
+            }
+            else {
+                value.clear();
+            }
         }
 
         constexpr auto use_memcpy = (
-            contiguous_containers<Type>          && 
-            primitive<typename Type::value_type> && 
-            !enforce_endianness<typename Type::value_type>
+            contiguous_containers<Type> &&
+            memcpy_element<typename Type::value_type>
         );
 
         if constexpr (use_memcpy) {
-            internal::read(buffer, static_cast<uint8_t*>(static_cast<void*>(value.data())), size * sizeof(typename Type::value_type));
+            if (!uses_varint<typename Type::value_type>(buffer)) {
+                internal::read(buffer, static_cast<uint8_t*>(static_cast<void*>(value.data())), size * sizeof(typename Type::value_type), state);
+                return;
+            }
         }
-        else {
-            for (uint32_t i = 0; i < size; i++) {
-                if constexpr (contiguous_containers<Type>) 
-                {
-                    deserialize(buffer, value[i]);
-                }
-                else if constexpr (std::same_as<Type, std::deque<typename Type::value_type>> ||
-                    std::same_as<Type, std::list<typename Type::value_type>>) 
-                {
-                    value.push_back({});
-                    deserialize(buffer, value.back());
-                }
-                else {
-                    typename Type::value_type element{};
-                    deserialize(buffer, element);
-                    value.insert(element);
-                }
+
+        // Stop at the first error instead of spinning on a bogus size
+        for (uint32_t i = 0; i < size && !internal::failed(state); i++) {
+            if constexpr (contiguous_containers<Type>) 
+            {
+                deserialize(buffer, value[i], state);
+            }
+            else if constexpr (is_sequence<Type>) 
+            {
+                value.push_back({});
+                deserialize(buffer, value.back(), state);
+            }
+            else {
+                typename Type::value_type element{};
+                deserialize(buffer, element, state);
+                value.insert(element);
             }
         }
     }
 
     template<typename Buffer, typename Type>
     requires kvp_containers<Type>
-    inline void deserialize(Buffer& buffer, Type& value) {
+    inline void deserialize(Buffer& buffer, Type& value, decode_state& state) {
         uint32_t size = 0;
-        deserialize(buffer, size);
+        deserialize(buffer, size, state);
+
+        uint32_t min_size = min_serialized_size<typename Type::key_type>(buffer) + min_serialized_size<typename Type::mapped_type>(buffer);
+
+        if (!internal::accept_length(buffer, size, min_size, sizeof(typename Type::value_type), state))
+            return;
 
         value.clear();
 
-        for (uint32_t i = 0; i < size; i++) {
+        for (uint32_t i = 0; i < size && !internal::failed(state); i++) {
             typename Type::key_type key{};
-            deserialize(buffer, key);
+            deserialize(buffer, key, state);
 
             value[key] = {};
-            deserialize(buffer, value[key]);
+            deserialize(buffer, value[key], state);
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "libnetwrk/net/type_traits.hpp"
+
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace libnetwrk {
+    /*
+        Integer that is always serialized as a LEB128 varint, zigzag encoded if signed.
+        Both ends must use the wrapper for the field.
+    */
+    template<typename Type>
+    requires (std::integral<Type> || is_enum<Type>) && (!std::same_as<Type, bool>)
+    struct varint {
+        using value_t = Type;
+
+        Type value = {};
+
+        varint() = default;
+
+        varint(Type value)
+            : value(value) {}
+
+        operator Type() const {
+            return value;
+        }
+
+        bool operator==(const varint&) const = default;
+    };
+}
+
+namespace libnetwrk::serialize::internal {
+    // Longest LEB128 encoding of an uint64_t
+    inline constexpr uint32_t max_varint_size = 10U;
+
+    /*
+        Integers wider than a byte, written as varints by compact buffers.
+    */
+    template<typename Type>
+    concept compact_integer = requires {
+        requires (std::integral<Type> || is_enum<Type>) &&
+                 !std::same_as<Type, bool>               &&
+                 sizeof(Type) > 1U;
+    };
+
+    template<typename Type>
+    concept is_varint = std::same_as<Type, varint<typename Type::value_t>>;
+
+    template<typename Type>
+    constexpr uint64_t to_varint(Type value) {
+        if constexpr (is_enum<Type>) {
+            return to_varint(static_cast<std::underlying_type_t<Type>>(value));
+        }
+        else if constexpr (std::is_signed_v<Type>) {
+            int64_t wide = static_cast<int64_t>(value);
+            return (static_cast<uint64_t>(wide) << 1) ^ static_cast<uint64_t>(wide >> 63);
+        }
+        else {
+            return static_cast<uint64_t>(value);
+        }
+    }
+
+    /*
+        @returns false if the decoded value doesn't fit the type
+    */
+    template<typename Type>
+    constexpr bool from_varint(uint64_t encoded, Type& value) {
+        if constexpr (is_enum<Type>) {
+            std::underlying_type_t<Type> underlying = {};
+
+            if (!from_varint(encoded, underlying))
+                return false;
+
+            value = static_cast<Type>(underlying);
+            return true;
+        }
+        else if constexpr (std::is_signed_v<Type>) {
+            int64_t wide = static_cast<int64_t>(encoded >> 1) ^ -static_cast<int64_t>(encoded & 1U);
+
+            if (wide < std::numeric_limits<Type>::min() || wide > std::numeric_limits<Type>::max())
+                return false;
+
+            value = static_cast<Type>(wide);
+            return true;
+        }
+        else {
+            if (encoded > std::numeric_limits<Type>::max())
+                return false;
+
+            value = static_cast<Type>(encoded);
+            return true;
+        }
+    }
+
+    constexpr uint32_t varint_size(uint64_t encoded) {
+        uint32_t size = 1U;
+
+        while (encoded >= 0x80U) {
+            encoded >>= 7;
+            size++;
+        }
+
+        return size;
+    }
+
+    /*
+        Write encoded to destination, which must hold max_varint_size bytes.
+
+        @returns number of bytes written
+    */
+    inline uint32_t encode_varint(uint64_t encoded, uint8_t* destination) {
+        uint32_t size = 0U;
+
+        while (encoded >= 0x80U) {
+            destination[size++] = static_cast<uint8_t>(encoded) | 0x80U;
+            encoded >>= 7;
+        }
+
+        destination[size++] = static_cast<uint8_t>(encoded);
+        return size;
+    }
+
+    /*
+        Read a varint from source, reading at most available bytes.
+
+        @returns number of bytes read, 0 if truncated or malformed
+    */
+    inline uint32_t decode_varint(const uint8_t* source, uint32_t available, uint64_t& encoded) {
+        // Small ids and counts take one or two bytes
+        if (available >= 1U && source[0] < 0x80U) {
+            encoded = source[0];
+            return 1U;
+        }
+
+        if (available >= 2U && source[1] < 0x80U) {
+            encoded = (source[0] & 0x7FU) | (static_cast<uint64_t>(source[1]) << 7);
+            return 2U;
+        }
+
+        encoded = 0U;
+
+        for (uint32_t i = 0U; i < available && i < max_varint_size; i++) {
+            encoded |= static_cast<uint64_t>(source[i] & 0x7FU) << (7U * i);
+
+            if (source[i] < 0x80U) {
+                // The last byte of a 10 byte varint only holds the top bit
+                if (i == max_varint_size - 1U && source[i] > 1U)
+                    break;
+
+                return i + 1U;
+            }
+        }
+
+        return 0U;
+    }
+}
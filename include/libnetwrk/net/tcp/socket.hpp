@@ -7,6 +7,7 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <string>
 #include <system_error>
 #include <functional>
 
@@ -24,21 +25,30 @@ namespace libnetwrk::tcp {
             : m_socket(context) {}
 
         socket(native_socket_t socket)
-            : m_socket(std::move(socket)) {}
+            : m_socket(std::move(socket))
+        {
+            cache_remote_endpoint();
+        }
+
+        /*
+            Adopt an accepted socket whose remote endpoint is already known.
+        */
+        socket(native_socket_t socket, std::string remote_ip, uint16_t remote_port)
+            : m_socket(std::move(socket)), m_remote_ip(std::move(remote_ip)), m_remote_port(remote_port) {}
 
     public:
         /*
-            Get socket ip address.
+            Get remote ip address. Cached on connect, empty if never connected.
         */
-        std::string get_ip() {
-            return m_socket.remote_endpoint().address().to_string();
+        const std::string& get_ip() const {
+            return m_remote_ip;
         }
 
         /*
-            Get socket port.
+            Get remote port. Cached on connect, 0 if never connected.
         */
-        uint16_t get_port() {
-            return m_socket.remote_endpoint().port();
+        uint16_t get_port() const {
+            return m_remote_port;
         }
 
         /*
@@ -50,11 +60,17 @@ namespace libnetwrk::tcp {
 
         void connect(const endpoint_t& endpoint) {
             m_socket.connect(endpoint);
+            cache_remote_endpoint();
         }
 
         bool connect(const endpoint_t& endpoint, std::error_code& ec) {
             m_socket.connect(endpoint, ec);
-            return !ec;
+
+            if (ec)
+                return false;
+
+            cache_remote_endpoint();
+            return true;
         }
 
     public:
@@ -67,6 +83,14 @@ namespace libnetwrk::tcp {
                 m_socket.close();
         }
 
+        /*
+            Stop sending, the peer reads everything written so far and then EOF.
+        */
+        void shutdown_send() {
+            std::error_code ec;
+            m_socket.shutdown(native_socket_t::shutdown_send, ec);
+        }
+
         template<typename Buffer>
         asio::awaitable<std::tuple<std::error_code, size_t>> async_read(Buffer& buffer) {
             std::tuple<std::error_code, size_t> result = co_await asio::async_read(m_socket,
@@ -88,5 +112,19 @@ namespace libnetwrk::tcp {
 
     private:
         native_socket_t m_socket;
+        std::string     m_remote_ip;
+        uint16_t        m_remote_port = 0U;
+
+    private:
+        void cache_remote_endpoint() {
+            std::error_code ec;
+            auto endpoint = m_socket.remote_endpoint(ec);
+
+            if (ec)
+                return;
+
+            m_remote_ip   = endpoint.address().to_string();
+            m_remote_port = endpoint.port();
+        }
     };
 }
@@ -3,8 +3,11 @@
 #include "libnetwrk/net/default_service_desc.hpp"
 #include "libnetwrk/net/tcp/socket.hpp"
 #include "libnetwrk/net/tcp/tcp_resolver.hpp"
+#include "libnetwrk/net/tcp/tcp_connector.hpp"
 #include "libnetwrk/net/core/client/client.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <exception>
 #include <thread>
 
@@ -25,6 +28,7 @@ namespace libnetwrk::tcp {
 
         virtual ~tcp_client() {
             this->m_context.status = to_underlying(service_status::stopping);
+            this->wait_for_detached();
             this->teardown();
         };
 
@@ -33,39 +37,46 @@ namespace libnetwrk::tcp {
         using native_socket_t = libnetwrk::tcp::socket::native_socket_t;
 
     private:
-        bool connect_impl(const std::string& host, const uint16_t port) override final {
+        asio::awaitable<bool> connect_impl(std::string host, uint16_t port) override final {
             try {
-                // Create resolver
-                tcp_resolver resolver(this->m_context.io_context);
+                // Resolving and connecting share the timeout
+                auto timeout  = std::chrono::milliseconds(this->m_context.settings.connect_timeout_ms);
+                auto deadline = std::chrono::steady_clock::now() + timeout;
 
                 // Resolve hostname
-                asio::ip::tcp::endpoint ep;
-                if (!resolver.get_endpoint(host, port, ep))
+                auto [r_ec, endpoints] = co_await tcp_resolver::co_get_endpoints(this->m_context.io_context, host, port, timeout);
+                if (r_ec == asio::error::timed_out)
+                    throw libnetwrk_exception("Timed out resolving hostname.");
+                if (r_ec)
                     throw libnetwrk_exception("Failed to resolve hostname.");
 
+                auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+
+                // Connect, racing all resolved endpoints
+                auto [ec, socket] = co_await tcp_connector::co_connect(this->m_context.io_context, endpoints,
+                    std::max(remaining, std::chrono::milliseconds(0)),
+                    std::chrono::milliseconds(this->m_context.settings.connect_attempt_delay_ms));
+
+                if (ec)
+                    throw libnetwrk_exception(ec.message());
+
                 // Create connection object
                 this->m_comp_connection.create_connection();
-
-                // Connect
-                this->m_comp_connection.establish_connection(ep);
+                this->m_comp_connection.establish_connection(std::move(socket));
 
                 // Start read/write
                 this->m_comp_message.start_connection_read_and_write(this->m_comp_connection.connection);
 
-                // Start context
-                this->m_context.start_io_context();
-
                 LIBNETWRK_INFO(this->m_context.name, "Connected to {}:{}.", host, port);
             }
             catch (const std::exception& e) {
                 (void)e;
 
                 LIBNETWRK_ERROR(this->m_context.name, "Failed to connect. | {}", e.what());
-                this->teardown();
-                return false;
+                co_return false;
             }
 
-            return true;
+            co_return true;
         }
     };
 }
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "asio.hpp"
+#include "asio/experimental/awaitable_operators.hpp"
+#include "libnetwrk/net/misc/async_event.hpp"
+
+#include <chrono>
+#include <memory>
+#include <tuple>
+#include <vector>
+#include <system_error>
+
+namespace libnetwrk::tcp {
+    /*
+        Races connection attempts to multiple endpoints (happy eyeballs).
+
+        Attempts are started attempt_delay apart, a failed attempt starts the next one
+        right away and the delay for the one after restarts from there. The first
+        established connection wins. All attempts still in flight are aborted once
+        a winner is found or the timeout expires.
+    */
+    class tcp_connector {
+    public:
+        using io_context_t    = asio::io_context;
+        using native_socket_t = asio::ip::tcp::socket;
+        using endpoint_t      = asio::ip::tcp::endpoint;
+        using result_t        = std::tuple<std::error_code, native_socket_t>;
+
+    public:
+        tcp_connector() = delete;
+
+    public:
+        static asio::awaitable<result_t> co_connect(io_context_t& context, const std::vector<endpoint_t>& endpoints,
+            std::chrono::milliseconds timeout, std::chrono::milliseconds attempt_delay)
+        {
+            using namespace asio::experimental::awaitable_operators;
+
+            if (endpoints.empty())
+                co_return result_t{ asio::error::host_not_found, native_socket_t(context) };
+
+            auto state = std::make_shared<state_t>(context, endpoints);
+
+            start_next_attempt(state);
+            asio::co_spawn(context, co_stagger(state, attempt_delay), asio::detached);
+
+            asio::steady_timer timer(context, timeout);
+
+            if (!state->finished)
+                co_await (state->done_event.wait() || timer.async_wait(asio::as_tuple(asio::use_awaitable)));
+
+            if (!state->finished) {
+                state->last_error = asio::error::timed_out;
+                state->finish();
+            }
+
+            if (state->winner == state_t::no_winner)
+                co_return result_t{ state->last_error, native_socket_t(context) };
+
+            co_return result_t{ std::error_code{}, std::move(state->sockets[state->winner]) };
+        }
+
+    private:
+        struct state_t {
+            static constexpr size_t no_winner = static_cast<size_t>(-1);
+
+            state_t(io_context_t& context, const std::vector<endpoint_t>& endpoints)
+                : context(context), endpoints(endpoints), delay_timer(context), done_event(context)
+            {
+                sockets.reserve(endpoints.size());
+
+                for (size_t i = 0; i < endpoints.size(); i++)
+                    sockets.emplace_back(context);
+            }
+
+            io_context_t&                context;
+            std::vector<endpoint_t>      endpoints;
+            std::vector<native_socket_t> sockets;
+            asio::steady_timer           delay_timer;
+            async_event                  done_event;
+
+            std::error_code last_error = asio::error::host_not_found;
+            size_t          started    = 0U;
+            size_t          failed     = 0U;
+            size_t          winner     = no_winner;
+            bool            finished   = false;
+
+            bool has_next() const {
+                return started < endpoints.size();
+            }
+
+            void finish() {
+                finished = true;
+
+                delay_timer.cancel();
+
+                for (size_t i = 0; i < sockets.size(); i++) {
+                    if (i == winner) continue;
+
+                    std::error_code ec;
+                    sockets[i].close(ec);
+                }
+
+                done_event.close();
+            }
+        };
+
+    private:
+        static void start_next_attempt(std::shared_ptr<state_t> state) {
+            size_t index = state->started++;
+            asio::co_spawn(state->context, co_attempt(state, index), asio::detached);
+        }
+
+        /*
+            Start the next attempt every delay, restarted whenever an attempt fails.
+        */
+        static asio::awaitable<void> co_stagger(std::shared_ptr<state_t> state, std::chrono::milliseconds delay) {
+            while (!state->finished && state->has_next()) {
+                state->delay_timer.expires_after(delay);
+                auto [ec] = co_await state->delay_timer.async_wait(asio::as_tuple(asio::use_awaitable));
+
+                // Cancelled by a failed attempt that already started the next one
+                if (!ec && !state->finished && state->has_next())
+                    start_next_attempt(state);
+            }
+        }
+
+        static asio::awaitable<void> co_attempt(std::shared_ptr<state_t> state, size_t index) {
+            auto [ec] = co_await state->sockets[index].async_connect(state->endpoints[index],
+                asio::as_tuple(asio::use_awaitable));
+
+            if (state->finished)
+                co_return;
+
+            if (!ec) {
+                state->winner = index;
+                state->finish();
+                co_return;
+            }
+
+            state->last_error = ec;
+
+            if (++state->failed == state->sockets.size()) {
+                state->finish();
+                co_return;
+            }
+
+            // Don't wait for the delay, start the next attempt right away
+            if (state->has_next()) {
+                start_next_attempt(state);
+                state->delay_timer.cancel();
+            }
+        }
+    };
+}
@@ -1,14 +1,43 @@
 #pragma once
 
+#include "asio.hpp"
+#include "asio/experimental/awaitable_operators.hpp"
+#include "libnetwrk/net/misc/async_event.hpp"
+
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <string>
-#include <regex>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
 
 namespace libnetwrk {
+    struct tcp_resolver_settings {
+        uint32_t cache_ttl_sec          = 60U;
+        uint32_t negative_cache_ttl_sec = 5U;
+
+        // Hosts kept in the cache, 0 disables caching
+        uint32_t max_cache_entries = 256U;
+    };
+
+    /*
+        Resolves hosts to IPv4 and IPv6 endpoints.
+
+        Accepts ip literals ("127.0.0.1", "::1", "[::1]"), hostnames and hostnames
+        prefixed with a scheme ("tcp://example.com"). A port in the host ("[::1]:80",
+        "example.com:80") is ignored, the port argument is used.
+
+        Resolved hostnames are kept in a bounded process wide cache. Hosts that don't
+        exist are cached for a shorter time, transient failures aren't cached.
+    */
     class tcp_resolver {
     public:
         using context_t  = asio::io_context;
         using endpoint_t = asio::ip::tcp::endpoint;
+        using address_t  = asio::ip::address;
+        using result_t   = std::tuple<std::error_code, std::vector<endpoint_t>>;
 
     public:
         tcp_resolver()                    = delete;
@@ -16,57 +45,387 @@ namespace libnetwrk {
         tcp_resolver(tcp_resolver&&)      = delete;
 
         tcp_resolver(context_t& context)
-            : m_context(context), m_native(context)
+            : m_native(context)
         {}
 
         tcp_resolver& operator=(const tcp_resolver&) = delete;
         tcp_resolver& operator=(tcp_resolver&&)      = delete;
 
     public:
-        bool get_endpoint(const std::string& host, uint16_t port, endpoint_t& out_endpoint) {
-            static const std::regex pattern("([a-zA-Z0-9]+):\\/\\/([a-zA-Z0-9.-]+)\\/*");
+        /*
+            Get resolver settings shared by all resolvers.
+        */
+        static tcp_resolver_settings get_settings() {
+            auto& cache = get_cache();
+            std::lock_guard<std::mutex> guard(cache.mutex);
+            return cache.settings;
+        }
+
+        /*
+            Set resolver settings shared by all resolvers.
+            Applies to lookups stored from now on.
+        */
+        static void set_settings(const tcp_resolver_settings& settings) {
+            auto& cache = get_cache();
+            std::lock_guard<std::mutex> guard(cache.mutex);
+            cache.settings = settings;
+
+            while (cache.entries.size() > cache.settings.max_cache_entries)
+                evict(cache);
+        }
+
+        /*
+            Check if a host has a cached lookup, successful or not.
+        */
+        static bool is_cached(const std::string& host) {
+            std::string_view name;
+            if (!parse_host(host, name))
+                return false;
+
+            auto& cache = get_cache();
+            std::lock_guard<std::mutex> guard(cache.mutex);
+
+            auto it = cache.entries.find(std::string(name));
+            return it != cache.entries.end() && it->second.expires > steady_clock_t::now();
+        }
 
-            std::string l_host = "";
-            std::smatch matches;
+        static void clear_cache() {
+            auto& cache = get_cache();
+            std::lock_guard<std::mutex> guard(cache.mutex);
+            cache.entries.clear();
+        }
+
+        /*
+            Cache a lookup result for a host, like a hosts file entry that expires.
+            Follows the same rules as looked up hosts, transient errors aren't stored.
+
+            @param ec -> lookup error, addresses are ignored if set
+        */
+        static void set_cached(const std::string& host, const std::vector<address_t>& addresses,
+            const std::error_code& ec = {})
+        {
+            std::string_view name;
+            if (!parse_host(host, name))
+                return;
+
+            cache_entry_t entry{};
+            entry.ec = ec;
 
-            if (std::regex_match(host, matches, pattern)) {
-                if (matches.size() != 3) return false;
+            if (!ec)
+                entry.addresses = addresses;
+
+            insert(name, std::move(entry));
+        }
+
+    public:
+        /*
+            Get a single endpoint, IPv4 preferred.
+        */
+        bool get_endpoint(const std::string& host, uint16_t port, endpoint_t& out_endpoint) {
+            std::vector<endpoint_t> endpoints;
+            if (!get_endpoints(host, port, endpoints))
+                return false;
 
-                asio::ip::tcp::resolver::query        query(matches[2], matches[1]);
-                asio::ip::tcp::resolver::results_type endpoints = m_native.resolve(query);
+            out_endpoint = endpoints.front();
 
-                for (const auto& endpoint : endpoints) {
-                    if (endpoint.endpoint().protocol() == asio::ip::tcp::v4()) {
-                        l_host = endpoint.endpoint().address().to_string();
-                        break;
-                    }
+            for (const auto& endpoint : endpoints) {
+                if (endpoint.protocol() == asio::ip::tcp::v4()) {
+                    out_endpoint = endpoint;
+                    break;
                 }
             }
-            else if (host == "localhost") {
-                l_host = "127.0.0.1";
-            }
-            else {
-                l_host = host;
-            }
 
-            if (l_host == "")
+            return true;
+        }
+
+        /*
+            Get all endpoints a host resolves to, blocking on cache miss.
+        */
+        bool get_endpoints(const std::string& host, uint16_t port, std::vector<endpoint_t>& out_endpoints) {
+            std::string_view name;
+            std::error_code  ec;
+
+            out_endpoints.clear();
+
+            if (!parse_host(host, name))
                 return false;
 
-            try {
-                out_endpoint = endpoint_t(asio::ip::address::from_string(l_host), port);
+            if (!resolve_local(name, port, ec, out_endpoints)) {
+                auto results = m_native.resolve(name, std::to_string(port), resolver_flags, ec);
+                store(name, results, ec, port, out_endpoints);
             }
-            catch (...) {
-                return false;
+
+            return !ec && !out_endpoints.empty();
+        }
+
+        /*
+            Get all endpoints a host resolves to without blocking on cache miss.
+        */
+        asio::awaitable<result_t> co_get_endpoints(std::string host, uint16_t port) {
+            return co_lookup(m_native, std::move(host), port);
+        }
+
+        /*
+            Get all endpoints a host resolves to within timeout.
+
+            A lookup in progress can't be interrupted, on timeout it's cancelled and
+            left to finish in the background while timed_out is returned right away.
+        */
+        static asio::awaitable<result_t> co_get_endpoints(context_t& context, std::string host, uint16_t port,
+            std::chrono::milliseconds timeout)
+        {
+            using namespace asio::experimental::awaitable_operators;
+
+            auto state = std::make_shared<timed_state_t>(context);
+
+            asio::co_spawn(context, co_resolve(state, std::move(host), port), asio::detached);
+
+            asio::steady_timer timer(context, timeout);
+
+            if (!state->finished)
+                co_await (state->done_event.wait() || timer.async_wait(asio::as_tuple(asio::use_awaitable)));
+
+            if (!state->finished) {
+                state->finished = true;
+                state->resolver.cancel();
             }
-            
-            return true;
+
+            co_return std::move(state->result);
+        }
+
+        /*
+            Cancel lookups in progress, they complete with operation_aborted.
+        */
+        void cancel() {
+            m_native.cancel();
         }
 
     private:
         using native_resolver_t = asio::ip::tcp::resolver;
+        using steady_clock_t    = std::chrono::steady_clock;
+
+        struct cache_entry_t {
+            std::vector<address_t>     addresses;
+            std::error_code            ec;
+            steady_clock_t::time_point expires;
+        };
+
+        struct cache_t {
+            tcp_resolver_settings                          settings;
+            std::unordered_map<std::string, cache_entry_t> entries;
+            std::mutex                                     mutex;
+        };
+
+        struct timed_state_t {
+            timed_state_t(context_t& context)
+                : resolver(context), done_event(context) {}
+
+            native_resolver_t resolver;
+            async_event       done_event;
+            result_t          result   = { asio::error::timed_out, std::vector<endpoint_t>{} };
+            bool              finished = false;
+        };
+
+        static constexpr auto resolver_flags = native_resolver_t::numeric_service;
 
     private:
-        context_t&        m_context;
         native_resolver_t m_native;
+
+    private:
+        static asio::awaitable<result_t> co_lookup(native_resolver_t& native, std::string host, uint16_t port) {
+            std::vector<endpoint_t> endpoints;
+            std::string_view        name;
+            std::error_code         ec;
+
+            if (!parse_host(host, name))
+                co_return result_t{ asio::error::host_not_found, std::move(endpoints) };
+
+            if (!resolve_local(name, port, ec, endpoints)) {
+                auto [r_ec, results] = co_await native.async_resolve(name, std::to_string(port), resolver_flags,
+                    asio::as_tuple(asio::use_awaitable));
+
+                ec = r_ec;
+                store(name, results, ec, port, endpoints);
+            }
+
+            if (!ec && endpoints.empty())
+                ec = asio::error::host_not_found;
+
+            co_return result_t{ ec, std::move(endpoints) };
+        }
+
+        static asio::awaitable<void> co_resolve(std::shared_ptr<timed_state_t> state, std::string host, uint16_t port) {
+            auto result = co_await co_lookup(state->resolver, std::move(host), port);
+
+            // Timed out already
+            if (state->finished)
+                co_return;
+
+            state->result   = std::move(result);
+            state->finished = true;
+            state->done_event.close();
+        }
+
+        static cache_t& get_cache() {
+            static cache_t cache;
+            return cache;
+        }
+
+        /*
+            Strip the scheme, path, port and ipv6 brackets from host.
+        */
+        static bool parse_host(std::string_view host, std::string_view& out_name) {
+            if (auto scheme_end = host.find("://"); scheme_end != std::string_view::npos)
+                host.remove_prefix(scheme_end + 3);
+
+            if (auto path_start = host.find('/'); path_start != std::string_view::npos)
+                host = host.substr(0, path_start);
+
+            if (!host.empty() && host.front() == '[') {
+                auto bracket_end = host.find(']');
+                if (bracket_end == std::string_view::npos)
+                    return false;
+
+                // Only a port may follow the brackets
+                if (!is_port_suffix(host.substr(bracket_end + 1)))
+                    return false;
+
+                host = host.substr(1, bracket_end - 1);
+            }
+            else if (auto colon = host.find(':'); colon != std::string_view::npos && host.find(':', colon + 1) == std::string_view::npos) {
+                // A single colon is a port, more than one is an unbracketed ipv6 literal
+                if (!is_port_suffix(host.substr(colon)))
+                    return false;
+
+                host = host.substr(0, colon);
+            }
+
+            out_name = host;
+            return !host.empty();
+        }
+
+        static bool is_port_suffix(std::string_view suffix) {
+            if (suffix.empty())
+                return true;
+
+            if (suffix.size() == 1 || suffix.size() > 6 || suffix.front() != ':')
+                return false;
+
+            for (char c : suffix.substr(1)) {
+                if (c < '0' || c > '9')
+                    return false;
+            }
+
+            return true;
+        }
+
+        /*
+            Definite answers are cached, anything that may succeed on retry isn't.
+        */
+        static bool is_cacheable(const std::error_code& ec) {
+            return !ec || ec == asio::error::host_not_found || ec == asio::error::no_data;
+        }
+
+        /*
+            Resolve literals and cached hosts.
+            Returns false if a resolver round trip is required.
+        */
+        static bool resolve_local(std::string_view name, uint16_t port, std::error_code& ec,
+            std::vector<endpoint_t>& out_endpoints)
+        {
+            // Both loopbacks, services may listen on either
+            if (name == "localhost") {
+                out_endpoints.emplace_back(asio::ip::address_v4::loopback(), port);
+                out_endpoints.emplace_back(asio::ip::address_v6::loopback(), port);
+                return true;
+            }
+
+            std::error_code literal_ec;
+            address_t       address = asio::ip::make_address(name, literal_ec);
+
+            if (!literal_ec) {
+                out_endpoints.emplace_back(address, port);
+                return true;
+            }
+
+            auto& cache = get_cache();
+            std::lock_guard<std::mutex> guard(cache.mutex);
+
+            auto it = cache.entries.find(std::string(name));
+            if (it == cache.entries.end())
+                return false;
+
+            if (it->second.expires <= steady_clock_t::now()) {
+                cache.entries.erase(it);
+                return false;
+            }
+
+            ec = it->second.ec;
+
+            for (const auto& cached : it->second.addresses)
+                out_endpoints.emplace_back(cached, port);
+
+            return true;
+        }
+
+        static void store(std::string_view name, const native_resolver_t::results_type& results,
+            const std::error_code& ec, uint16_t port, std::vector<endpoint_t>& out_endpoints)
+        {
+            cache_entry_t entry{};
+            entry.ec = ec;
+
+            if (!ec) {
+                for (const auto& result : results) {
+                    entry.addresses.push_back(result.endpoint().address());
+                    out_endpoints.emplace_back(result.endpoint().address(), port);
+                }
+            }
+
+            insert(name, std::move(entry));
+        }
+
+        static void insert(std::string_view name, cache_entry_t&& entry) {
+            if (!is_cacheable(entry.ec))
+                return;
+
+            auto& cache = get_cache();
+            std::lock_guard<std::mutex> guard(cache.mutex);
+
+            uint32_t ttl = entry.ec ? cache.settings.negative_cache_ttl_sec : cache.settings.cache_ttl_sec;
+            if (ttl == 0U || cache.settings.max_cache_entries == 0U)
+                return;
+
+            entry.expires = steady_clock_t::now() + std::chrono::seconds(ttl);
+
+            std::string key(name);
+            if (!cache.entries.contains(key) && cache.entries.size() >= cache.settings.max_cache_entries)
+                evict(cache);
+
+            cache.entries[std::move(key)] = std::move(entry);
+        }
+
+        /*
+            Drop expired entries, or the one closest to expiring if none are.
+            Cache mutex must be held.
+        */
+        static void evict(cache_t& cache) {
+            auto now    = steady_clock_t::now();
+            auto oldest = cache.entries.end();
+
+            for (auto it = cache.entries.begin(); it != cache.entries.end();) {
+                if (it->second.expires <= now) {
+                    it = cache.entries.erase(it);
+                    continue;
+                }
+
+                if (oldest == cache.entries.end() || it->second.expires < oldest->second.expires)
+                    oldest = it;
+
+                it++;
+            }
+
+            if (cache.entries.size() >= cache.settings.max_cache_entries && oldest != cache.entries.end())
+                cache.entries.erase(oldest);
+        }
     };
 }
@@ -5,7 +5,13 @@
 #include "libnetwrk/net/tcp/tcp_resolver.hpp"
 #include "libnetwrk/net/core/service/service.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <exception>
+#include <memory>
+#include <mutex>
 #include <thread>
 
 namespace libnetwrk::tcp {
@@ -34,19 +40,68 @@ namespace libnetwrk::tcp {
         }
 
     protected:
-        using acceptor_t = asio::ip::tcp::acceptor;
+        using acceptor_t      = asio::ip::tcp::acceptor;
+        using native_socket_t = asio::ip::tcp::socket;
 
     protected:
         acceptor_t m_acceptor;
 
     private:
+        void close_acceptor() {
+            std::error_code ec;
+            m_acceptor.close(ec);
+        }
+
         void teardown() override final {
+            // Listeners are cancelled by the base, the acceptor is only closed once the io thread is done with it
+            base_t::teardown();
+
             if (m_acceptor.is_open())
                 m_acceptor.close();
-
-            base_t::teardown();
         };
 
+        void stop_accepting() override final {
+            auto& io_context = this->m_context.io_context;
+
+            // Nothing else uses the acceptor here, close it directly
+            if (io_context.stopped() || io_context.get_executor().running_in_this_thread()) {
+                close_acceptor();
+                return;
+            }
+
+            struct close_state_t {
+                std::mutex              mutex;
+                std::condition_variable cv;
+                bool                    closed    = false;
+                bool                    abandoned = false;
+            };
+
+            auto state = std::make_shared<close_state_t>();
+
+            // Acceptor is used by the io thread, close it there
+            asio::post(io_context, [this, state] {
+                std::lock_guard<std::mutex> guard(state->mutex);
+
+                if (state->abandoned)
+                    return;
+
+                close_acceptor();
+                state->closed = true;
+                state->cv.notify_all();
+            });
+
+            std::unique_lock<std::mutex> lock(state->mutex);
+
+            // A stopped io context never runs the close, check on it every so often
+            while (!state->cv.wait_for(lock, std::chrono::milliseconds(100), [&state] { return state->closed; })) {
+                if (io_context.stopped()) {
+                    state->abandoned = true;
+                    close_acceptor();
+                    return;
+                }
+            }
+        }
+
         bool start_impl(const std::string& host, const uint16_t port) override final {
             using namespace asio::experimental::awaitable_operators;
 
@@ -60,18 +115,33 @@ namespace libnetwrk::tcp {
                     throw libnetwrk_exception("Failed to resolve hostname.");
 
                 // Open acceptor
-                m_acceptor.open(asio::ip::tcp::v4());
+                m_acceptor.open(ep.protocol());
                 m_acceptor.set_option(acceptor_t::reuse_address(true));
                 m_acceptor.bind(ep);
                 m_acceptor.listen();
 
-                // Start listening
-                asio::co_spawn(this->m_context.io_context, co_listen() || this->m_context.cancel_cv.wait(), [this](auto, auto) {
-                    LIBNETWRK_INFO(this->m_context.name, "Stopped listening.");
-                });
+                LIBNETWRK_INFO(this->m_context.name, "Listening for connections on {}:{}.",
+                    m_acceptor.local_endpoint().address().to_string(),
+                    m_acceptor.local_endpoint().port());
+
+                // Start listening, several accepts outstanding so a burst of connects
+                // is drained without waiting for each accepted connection to be set up
+                uint32_t pending_accepts = std::max<uint32_t>(this->m_context.settings.pending_accepts, 1U);
+                auto     listeners       = std::make_shared<std::atomic_uint32_t>(pending_accepts);
 
-                // Start GC
+                for (uint32_t i = 0U; i < pending_accepts; i++) {
+                    asio::co_spawn(this->m_context.io_context, co_listen() || this->m_context.cancel_event.wait(), [this, listeners](auto, auto) {
+                        if (--(*listeners) == 0U)
+                            LIBNETWRK_INFO(this->m_context.name, "Stopped listening.");
+                    });
+                }
+
+                this->m_comp_connection.start_admission();
+                this->m_comp_connection.warm_up_pool();
+
+                // Start GC and connection deadlines
                 this->m_comp_connection.start_gc();
+                this->m_comp_connection.start_timers();
 
                 // Start context
                 this->m_context.start_io_context();
@@ -91,15 +161,10 @@ namespace libnetwrk::tcp {
         asio::awaitable<void> co_listen() {
             auto current_executor = co_await asio::this_coro::executor;
 
-            LIBNETWRK_INFO(this->m_context.name, "Listening for connections on {}:{}.",
-                m_acceptor.local_endpoint().address().to_string(),
-                m_acceptor.local_endpoint().port());
-
             while (true) {
-                auto connection = std::make_shared<connection_internal_t>(this->m_context.io_context);
+                native_socket_t socket(this->m_context.io_context);
 
-                auto [ec] = co_await m_acceptor.async_accept(connection->get_socket().native(),
-                    asio::as_tuple(asio::use_awaitable));
+                auto [ec] = co_await m_acceptor.async_accept(socket, asio::as_tuple(asio::use_awaitable));
 
                 if (ec) {
                     if (ec != asio::error::operation_aborted) {
@@ -109,10 +174,37 @@ namespace libnetwrk::tcp {
                     break;
                 }
 
+                std::error_code endpoint_ec;
+                auto remote = socket.remote_endpoint(endpoint_ec);
+
+                // Peer already gone
+                if (endpoint_ec)
+                    continue;
+
+                // Shed before any allocation or auth work
+                if (!this->m_comp_connection.try_admit(remote.address())) {
+                    LIBNETWRK_DEBUG(this->m_context.name, "[{}:{}] Connection shed.", remote.address().to_string(), remote.port());
+                    shed(socket);
+                    continue;
+                }
+
+                auto connection = this->m_comp_connection.create_connection();
+                connection->accept(std::move(socket), remote.address().to_string(), remote.port());
+                connection->is_admitted = true;
+
                 asio::co_spawn(current_executor, co_accept(connection), asio::detached);
             }
         }
 
+        /*
+            Reset the connection instead of a graceful close, so shed connections don't linger in TIME_WAIT.
+        */
+        static void shed(native_socket_t& socket) {
+            std::error_code ec;
+            socket.set_option(asio::socket_base::linger(true, 0), ec);
+            socket.close(ec);
+        }
+
         asio::awaitable<void> co_accept(std::shared_ptr<connection_internal_t> connection) {
             LIBNETWRK_VERBOSE(this->m_context.name, "[{}:{}] Attempted connection.",
                 connection->get_ip(), connection->get_port());
@@ -120,7 +212,7 @@ namespace libnetwrk::tcp {
             if (!this->m_context.cb_before_connect || this->m_context.cb_before_connect(std::static_pointer_cast<connection_t>(connection))) {
                 this->m_comp_connection.accept_connection(connection);
                 this->m_comp_message.start_connection_read_and_write(connection);
-                this->m_comp_system_message.send_auth_message(connection);
+                this->m_comp_system_message.start_authentication(connection);
 
                 if (this->m_context.cb_connect)
                     this->m_context.cb_connect(std::static_pointer_cast<connection_t>(connection));
@@ -130,6 +222,7 @@ namespace libnetwrk::tcp {
             }
             else {
                 LIBNETWRK_WARNING(this->m_context.name, "[{}:{}] Connection denied.", connection->get_ip(), connection->get_port());
+                this->m_comp_connection.release_admission(*connection);
             }
 
             co_return;
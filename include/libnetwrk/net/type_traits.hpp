@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <type_traits>
 
 namespace {
@@ -23,4 +24,21 @@ namespace libnetwrk {
 
     template <typename Desc>
     constexpr bool desc_has_storage_type = has_storage_type_typename<Desc>::value;
+
+    /*
+        Specialize as true to serialize a trivially copyable, standard layout type
+        as its raw bytes with a single memcpy. Both ends must share the type's layout.
+
+        Types with padding are rejected, the padding would be sent uninitialized.
+        The compiler can't rule out padding for types with floating point members,
+        those also specialize serialize_as_bytes_size as the sum of their member sizes.
+
+        Received bytes aren't validated. A bool or enum member holding a value outside
+        its valid range is undefined behavior, only use them with trusted peers.
+    */
+    template<typename T>
+    inline constexpr bool serialize_as_bytes = false;
+
+    template<typename T>
+    inline constexpr size_t serialize_as_bytes_size = 0U;
 }
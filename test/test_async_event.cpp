@@ -0,0 +1,177 @@
+#include "libnetwrk/net/misc/async_event.hpp"
+#include "asio/experimental/awaitable_operators.hpp"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace libnetwrk;
+
+static asio::awaitable<void> co_count_wakes(async_event& event, std::atomic_uint32_t& wakes, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        co_await event.wait();
+        wakes++;
+    }
+}
+
+TEST(async_event, pending_notify_completes_next_wait) {
+    asio::io_context     context(1);
+    async_event          event(context);
+    std::atomic_uint32_t wakes = 0U;
+
+    event.notify_one();
+    asio::co_spawn(context, co_count_wakes(event, wakes, 1U), asio::detached);
+    context.run();
+
+    EXPECT_TRUE(wakes == 1U);
+    EXPECT_FALSE(event.has_active_operations());
+}
+
+TEST(async_event, notifies_coalesce) {
+    asio::io_context     context(1);
+    async_event          event(context);
+    std::atomic_uint32_t wakes = 0U;
+
+    for (int i = 0; i < 10; i++)
+        event.notify_one();
+
+    asio::co_spawn(context, co_count_wakes(event, wakes, 2U), asio::detached);
+    context.run_for(std::chrono::milliseconds(100));
+
+    EXPECT_TRUE(wakes == 1U);
+    EXPECT_TRUE(event.has_active_operations());
+}
+
+TEST(async_event, notify_from_other_thread) {
+    asio::io_context     context(1);
+    async_event          event(context);
+    std::atomic_uint32_t wakes = 0U;
+
+    auto work = asio::make_work_guard(context);
+    asio::co_spawn(context, co_count_wakes(event, wakes, 1000U), [&](auto) { work.reset(); });
+
+    std::thread io_thread([&context] { context.run(); });
+
+    while (wakes != 1000U) {
+        event.notify_one();
+        std::this_thread::yield();
+    }
+
+    io_thread.join();
+    EXPECT_TRUE(wakes == 1000U);
+}
+
+TEST(async_event, close_completes_all_waits) {
+    asio::io_context     context(1);
+    async_event          event(context);
+    std::atomic_uint32_t wakes = 0U;
+
+    asio::co_spawn(context, co_count_wakes(event, wakes, 1U), asio::detached);
+    asio::co_spawn(context, co_count_wakes(event, wakes, 1U), asio::detached);
+    context.run_for(std::chrono::milliseconds(10));
+
+    EXPECT_TRUE(wakes == 0U);
+
+    event.close();
+    context.restart();
+    context.run();
+
+    EXPECT_TRUE(wakes == 2U);
+
+    // Stays closed for later waits
+    asio::co_spawn(context, co_count_wakes(event, wakes, 5U), asio::detached);
+    context.restart();
+    context.run();
+
+    EXPECT_TRUE(wakes == 7U);
+
+    event.reset();
+    asio::co_spawn(context, co_count_wakes(event, wakes, 1U), asio::detached);
+    context.restart();
+    context.run_for(std::chrono::milliseconds(10));
+
+    EXPECT_TRUE(wakes == 7U);
+}
+
+TEST(async_event, cancelled_by_awaitable_operator) {
+    using namespace asio::experimental::awaitable_operators;
+
+    asio::io_context   context(1);
+    async_event        event(context);
+    asio::steady_timer timer(context, std::chrono::milliseconds(10));
+    bool               done = false;
+
+    asio::co_spawn(context, event.wait() || timer.async_wait(asio::use_awaitable), [&](auto, auto result) {
+        done = result.index() == 1U;
+    });
+
+    context.run();
+
+    EXPECT_TRUE(done);
+    EXPECT_FALSE(event.has_active_operations());
+}
+
+TEST(async_event, completes_on_bound_executor) {
+    asio::io_context context(1);
+    asio::io_context other_context(1);
+    async_event      event(context);
+    bool             on_other = false;
+
+    event.async_wait(asio::bind_executor(other_context, [&] {
+        on_other = other_context.get_executor().running_in_this_thread();
+    }));
+
+    event.notify_one();
+    context.run();
+
+    EXPECT_FALSE(on_other);
+
+    other_context.run();
+
+    EXPECT_TRUE(on_other);
+}
+
+TEST(async_event, cancel_after_completion) {
+    asio::io_context          context(1);
+    auto                      event = std::make_unique<async_event>(context);
+    asio::cancellation_signal signal;
+    bool                      done  = false;
+
+    event->async_wait(asio::bind_cancellation_slot(signal.slot(), [&] {
+        done = true;
+    }));
+
+    event->notify_one();
+    context.run();
+    event.reset();
+
+    // The completed wait must no longer reach into the destroyed event
+    signal.emit(asio::cancellation_type::all);
+
+    EXPECT_TRUE(done);
+}
+
+TEST(async_event, wait_for_end) {
+    asio::io_context     context(1);
+    async_event          event(context);
+    std::atomic_uint32_t wakes = 0U;
+
+    auto work = asio::make_work_guard(context);
+    asio::co_spawn(context, co_count_wakes(event, wakes, 1U), asio::detached);
+
+    std::thread io_thread([&context] { context.run(); });
+
+    while (!event.has_active_operations())
+        std::this_thread::yield();
+
+    event.close();
+    event.wait_for_end();
+
+    EXPECT_FALSE(event.has_active_operations());
+
+    work.reset();
+    io_thread.join();
+    EXPECT_TRUE(wakes == 1U);
+}
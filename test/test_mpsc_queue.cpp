@@ -0,0 +1,88 @@
+#include "libnetwrk/net/containers/mpsc_queue.hpp"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace libnetwrk;
+
+TEST(mpsc_queue, fifo_order) {
+    mpsc_queue<int> queue;
+    int value = 0;
+
+    EXPECT_TRUE(queue.empty());
+    EXPECT_FALSE(queue.try_pop(value));
+
+    for (int i = 0; i < 100; i++)
+        queue.push(i);
+
+    EXPECT_TRUE(queue.size() == 100);
+
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TRUE(queue.try_pop(value));
+        ASSERT_TRUE(value == i);
+    }
+
+    EXPECT_TRUE(queue.empty());
+    EXPECT_FALSE(queue.try_pop(value));
+}
+
+TEST(mpsc_queue, clear_releases_values) {
+    auto value = std::make_shared<int>(1);
+
+    {
+        mpsc_queue<std::shared_ptr<int>> queue;
+
+        for (int i = 0; i < 10; i++)
+            queue.push(value);
+
+        queue.clear();
+
+        EXPECT_TRUE(queue.empty());
+        EXPECT_TRUE(value.use_count() == 1);
+
+        // Destroying a non-empty queue releases values too
+        queue.push(value);
+    }
+
+    EXPECT_TRUE(value.use_count() == 1);
+}
+
+TEST(mpsc_queue, concurrent_producers) {
+    constexpr int producers = 4;
+    constexpr int per_producer = 20000;
+
+    mpsc_queue<int> queue;
+    std::vector<std::thread> threads;
+
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&queue, p] {
+            for (int i = 0; i < per_producer; i++)
+                queue.push(p * per_producer + i);
+        });
+    }
+
+    // Values of each producer come out in the order it pushed them
+    std::vector<int> last(producers, -1);
+    int popped = 0;
+    int value  = 0;
+
+    while (popped != producers * per_producer) {
+        if (!queue.try_pop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        int producer = value / per_producer;
+        ASSERT_TRUE(value > last[producer]);
+
+        last[producer] = value;
+        popped++;
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_TRUE(queue.empty());
+}
@@ -1,4 +1,5 @@
 #include "libnetwrk/net/serialize/serialize.hpp"
+#include "libnetwrk/net/messages/outgoing_message.hpp"
 
 #include <gtest/gtest.h>
 #include <cstring>
@@ -13,6 +14,9 @@
 #include <unordered_map>
 #include <forward_list>
 #include <stack>
+#include <span>
+#include <string_view>
+#include <memory_resource>
 
 #ifdef LIBNETWRK_SERIALIZE_TEST_BUFFER_DYNAMIC
     #define __BUFFER libnetwrk::dynamic_buffer
@@ -109,6 +113,78 @@ struct architecture_struct {
     }
 };
 
+struct pod_struct {
+    uint32_t id          = 0U;
+    float    position[3] = {};
+    uint32_t flags       = 0U;
+
+    bool operator==(const pod_struct&) const = default;
+};
+
+template<>
+inline constexpr bool libnetwrk::serialize_as_bytes<pod_struct> = true;
+
+template<>
+inline constexpr size_t libnetwrk::serialize_as_bytes_size<pod_struct> = sizeof(uint32_t) * 2U + sizeof(float) * 3U;
+
+struct int_pod_struct {
+    uint32_t id    = 0U;
+    uint16_t kind  = 0U;
+    uint16_t flags = 0U;
+};
+
+template<>
+inline constexpr bool libnetwrk::serialize_as_bytes<int_pod_struct> = true;
+
+// 3 padding bytes after flags
+struct padded_pod_struct {
+    uint32_t id    = 0U;
+    uint8_t  flags = 0U;
+};
+
+template<>
+inline constexpr bool libnetwrk::serialize_as_bytes<padded_pod_struct> = true;
+
+// Declared size doesn't account for the padding
+struct padded_float_pod_struct {
+    float   x     = 0.0f;
+    uint8_t flags = 0U;
+};
+
+template<>
+inline constexpr bool libnetwrk::serialize_as_bytes<padded_float_pod_struct> = true;
+
+template<>
+inline constexpr size_t libnetwrk::serialize_as_bytes_size<padded_float_pod_struct> = sizeof(float) + sizeof(uint8_t);
+
+struct sized_struct : base_struct {
+    size_t serialized_size() const {
+        return sizeof(a) + sizeof(uint32_t) + b.size();
+    }
+};
+
+// Takes no bytes on the wire
+struct empty_struct {
+    static constexpr uint32_t min_serialized_size = 0U;
+
+    void serialize(__BUFFER&) const {}
+    void deserialize(__BUFFER&) {}
+};
+
+TEST(serialize, buffer_concept) {
+    EXPECT_TRUE(libnetwrk::is_buffer<libnetwrk::dynamic_buffer>);
+    EXPECT_TRUE(libnetwrk::is_buffer<libnetwrk::fixed_buffer<25>>);
+    EXPECT_FALSE(libnetwrk::is_buffer<std::vector<uint8_t>>);
+
+    // No vtable pointer, data() and size() are direct calls
+    EXPECT_FALSE(std::is_polymorphic_v<libnetwrk::dynamic_buffer>);
+    EXPECT_FALSE(std::is_polymorphic_v<libnetwrk::fixed_buffer<25>>);
+
+    // Every outgoing message holds a serialized head, decode state stays off both
+    static_assert(sizeof(libnetwrk::fixed_buffer<25>) <= 48U);
+    static_assert(sizeof(libnetwrk::dynamic_buffer)   <= sizeof(libnetwrk::byte_vector) + 32U);
+}
+
 TEST(serialize, supported) {
     EXPECT_TRUE((libnetwrk::serialize::internal::serialize_supported<__BUFFER, bool>));
     EXPECT_TRUE((libnetwrk::serialize::internal::serialize_supported<__BUFFER, char>));
@@ -222,8 +298,8 @@ static void read_to_buffer(const std::filesystem::path& filename, __BUFFER& buff
     std::ifstream stream(filename, std::ios::binary);
     ASSERT_TRUE(stream.is_open());
 
-    auto& underlying = buffer.underlying();
-    underlying = { (std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>() };
+    std::vector<uint8_t> bytes = { (std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>() };
+    buffer.underlying().assign(bytes.data(), bytes.size());
 
     stream.close();
 };
@@ -868,3 +944,733 @@ TEST(serialize, multiple_containers) {
     ASSERT_TRUE(v1 == v2);
     ASSERT_TRUE(s1 == s2);
 }
+
+TEST(serialize, serialized_size) {
+    using namespace libnetwrk::serialize;
+
+    static_assert(serialized_size(uint16_t(0)) == 2U);
+    static_assert(serialized_size(double(0)) == 8U);
+    static_assert(serialized_size(std::array<int32_t, 5>{}) == 24U);
+    static_assert(serialized_size(std::array<std::array<uint8_t, 3>, 2>{}) == 18U);
+
+    __BUFFER buffer;
+
+    auto check = [&buffer](const auto& value) {
+        buffer.clear();
+        buffer << value;
+
+    #ifdef LIBNETWRK_SERIALIZE_TEST_BUFFER_DYNAMIC
+        return serialized_size(value) == buffer.size();
+    #else
+        return serialized_size(value) == get_buffer_write_index(buffer);
+    #endif
+    };
+
+    EXPECT_TRUE(check(std::string("abcdef")));
+    EXPECT_TRUE(check("testing"));
+    EXPECT_TRUE(check(std::vector<uint64_t>{ 1, 2, 3 }));
+    EXPECT_TRUE(check(std::vector<std::string>{ "a", "bc", "def" }));
+    EXPECT_TRUE(check(std::deque<int16_t>{ 4, 5 }));
+    EXPECT_TRUE(check(std::list<std::string>{ "ghij" }));
+    EXPECT_TRUE(check(std::set<int>{ 6, 7, 8 }));
+    EXPECT_TRUE(check(std::unordered_set<std::string>{ "k", "lm" }));
+    EXPECT_TRUE(check(std::map<int, std::string>{ { 1, "n" }, { 2, "op" } }));
+    EXPECT_TRUE(check(std::unordered_map<std::string, std::vector<int>>{ { "q", { 9, 10 } } }));
+    EXPECT_TRUE(check(sized_struct{}));
+    EXPECT_TRUE(check(std::vector<sized_struct>(3)));
+
+    // Without a serialized_size() member the size is unknown
+    EXPECT_TRUE(serialized_size(derived_struct{}) == 0U);
+}
+
+enum class compact_enum : uint32_t {
+    first = 1,
+    large = 300000
+};
+
+TEST(serialize, varint) {
+    __BUFFER buffer;
+
+    {
+        varint<uint64_t> v1 = 127U;
+        varint<uint64_t> v2 = 0U;
+
+        buffer << v1;
+        EXPECT_TRUE(serialize::serialized_size(v1) == 1U);
+
+        buffer >> v2;
+        EXPECT_TRUE(v1 == v2);
+    }
+
+    buffer.clear();
+
+    {
+        varint<uint64_t> v1 = UINT64_MAX;
+        varint<uint64_t> v2 = 0U;
+
+        buffer << v1 >> v2;
+        EXPECT_TRUE(v1 == v2);
+        EXPECT_TRUE(serialize::serialized_size(v1) == 10U);
+    }
+
+    buffer.clear();
+
+    {
+        std::vector<varint<int32_t>> v1{ 0, -1, 1, -64, 64, INT32_MIN, INT32_MAX };
+        std::vector<varint<int32_t>> v2{};
+
+        buffer << v1 >> v2;
+        EXPECT_TRUE(v1 == v2);
+
+        // Zigzag keeps small negative values small
+        EXPECT_TRUE(serialize::serialized_size(varint<int32_t>(-64)) == 1U);
+        EXPECT_TRUE(serialize::serialized_size(varint<int32_t>(64)) == 2U);
+    }
+
+    buffer.clear();
+
+    {
+        varint<uint32_t> v1 = 0U;
+
+        buffer << varint<uint64_t>(UINT64_MAX);
+        EXPECT_THROW(buffer >> v1, libnetwrk::libnetwrk_exception);
+    }
+
+    buffer.clear();
+
+    {
+        varint<uint64_t> v1 = 0U;
+        uint8_t          truncated = 0x80U;
+
+        buffer << truncated;
+        EXPECT_THROW(buffer >> v1, libnetwrk::libnetwrk_exception);
+    }
+}
+
+TEST(serialize, compact) {
+    __BUFFER buffer;
+    buffer.set_compact(true);
+
+    int16_t                      v1 = -300;
+    uint64_t                     v2 = 5U;
+    compact_enum                 v3 = compact_enum::large;
+    std::string                  v4 = "abc";
+    std::vector<uint32_t>        v5{ 1, 2, 3, 128 };
+    std::map<int64_t, float>     v6{ { -1, 1.5f }, { 1, 2.5f } };
+
+    buffer << v1 << v2 << v3 << v4 << v5 << v6;
+
+#ifdef LIBNETWRK_SERIALIZE_TEST_BUFFER_DYNAMIC
+    uint32_t written = buffer.size();
+#else
+    uint32_t written = get_buffer_write_index(buffer);
+#endif
+
+    // 2 + 1 + 3 + (1 + 3) + (1 + 5) + (1 + 2 * (1 + 4))
+    EXPECT_TRUE(written == 27U);
+
+    int16_t                  r1 = 0;
+    uint64_t                 r2 = 0U;
+    compact_enum             r3 = compact_enum::first;
+    std::string              r4;
+    std::vector<uint32_t>    r5;
+    std::map<int64_t, float> r6;
+
+    buffer >> r1 >> r2 >> r3 >> r4 >> r5 >> r6;
+
+    EXPECT_TRUE(v1 == r1);
+    EXPECT_TRUE(v2 == r2);
+    EXPECT_TRUE(v3 == r3);
+    EXPECT_TRUE(v4 == r4);
+    EXPECT_TRUE(v5 == r5);
+    EXPECT_TRUE(v6 == r6);
+}
+
+TEST(serialize, as_bytes) {
+    static_assert(serialize::serialized_size(pod_struct{}) == sizeof(pod_struct));
+    static_assert(serialize::serialized_size(int_pod_struct{}) == sizeof(int_pod_struct));
+    static_assert(!libnetwrk::serialize::internal::serialize_supported<__BUFFER, std::pair<int, int>>);
+    static_assert(!libnetwrk::serialize::internal::serialize_supported<__BUFFER, padded_pod_struct>);
+    static_assert(!libnetwrk::serialize::internal::serialize_supported<__BUFFER, padded_float_pod_struct>);
+
+    __BUFFER buffer;
+
+    {
+        pod_struct v1{ 7U, { 1.0f, 2.0f, 3.0f }, 9U };
+        pod_struct v2{};
+
+        buffer << v1 >> v2;
+        EXPECT_TRUE(v1 == v2);
+    }
+
+    buffer.clear();
+
+    {
+        std::vector<pod_struct> v1{ { 1U, { 1.0f }, 1U }, { 2U, { 2.0f }, 2U } };
+        std::vector<pod_struct> v2{};
+
+        buffer << v1;
+        EXPECT_TRUE(serialize::serialized_size(v1) == sizeof(uint32_t) + 2U * sizeof(pod_struct));
+
+        buffer >> v2;
+        EXPECT_TRUE(v1 == v2);
+    }
+}
+
+TEST(serialize, views) {
+    __BUFFER buffer;
+
+    {
+        std::string      v1 = "viewed in place";
+        std::string_view v2;
+
+        buffer << v1 >> v2;
+        EXPECT_TRUE(v1 == v2);
+        EXPECT_TRUE(v2.data() > static_cast<const void*>(buffer.data()));
+    }
+
+    buffer.clear();
+
+    {
+        std::string_view v1 = "forwarded";
+        std::string      v2;
+
+        buffer << v1 >> v2;
+        EXPECT_TRUE(v1 == v2);
+    }
+
+    buffer.clear();
+
+    {
+        std::vector<uint8_t>     v1{ 1, 2, 3, 4 };
+        std::span<const uint8_t> v2;
+
+        buffer << v1 >> v2;
+        EXPECT_TRUE(std::equal(v1.begin(), v1.end(), v2.begin(), v2.end()));
+
+        __BUFFER             other;
+        std::vector<uint8_t> v3;
+
+        other << v2 >> v3;
+        EXPECT_TRUE(v1 == v3);
+        EXPECT_TRUE(serialize::serialized_size(v2) == 8U);
+    }
+
+    buffer.clear();
+
+    {
+        // The length prefix keeps 4 byte elements aligned
+        std::vector<uint32_t>     v1{ 10, 20, 30 };
+        std::span<const uint32_t> v2;
+
+        buffer << v1 >> v2;
+        EXPECT_TRUE(std::equal(v1.begin(), v1.end(), v2.begin(), v2.end()));
+    }
+
+    buffer.clear();
+
+    {
+        // Written as views, read into vectors
+        static_assert(!readable_span_view<std::span<const uint64_t>>);
+        static_assert(!readable_span_view<std::span<const double>>);
+
+        std::vector<uint64_t>     v1{ UINT64_MAX, 0U, 1234567890123U };
+        std::vector<double>       v2{ 1.5, -2.25, 1e300 };
+        std::span<const uint64_t> s1(v1);
+        std::span<const double>   s2(v2);
+        std::vector<uint64_t>     r1;
+        std::vector<double>       r2;
+
+        buffer << s1 << s2 >> r1 >> r2;
+        EXPECT_TRUE(v1 == r1);
+        EXPECT_TRUE(v2 == r2);
+    }
+
+    buffer.clear();
+
+    {
+        std::vector<uint32_t>     v1{ 10, 20, 30 };
+        std::span<const uint32_t> v2;
+        uint8_t                   misalign = 0U;
+
+        buffer << misalign << v1 >> misalign;
+        EXPECT_THROW(buffer >> v2, libnetwrk::libnetwrk_exception);
+    }
+
+    buffer.clear();
+
+    {
+        std::string_view v1;
+
+        buffer << uint32_t(100);
+        EXPECT_THROW(buffer >> v1, libnetwrk::libnetwrk_exception);
+    }
+}
+
+#ifdef LIBNETWRK_SERIALIZE_TEST_BUFFER_DYNAMIC
+TEST(serialize, views_follow_move) {
+    libnetwrk::dynamic_buffer buffer;
+    std::string_view          view;
+
+    // Small enough for the inline bytes, taking the view moves them out
+    buffer << std::string("abc") >> view;
+
+    libnetwrk::dynamic_buffer moved(std::move(buffer));
+    libnetwrk::dynamic_buffer assigned;
+    assigned = std::move(moved);
+
+    EXPECT_TRUE(view == "abc");
+    EXPECT_TRUE(view.data() == static_cast<void*>(assigned.data() + 4));
+}
+#endif
+
+#if defined(LIBNETWRK_SERIALIZE_TEST_BUFFER_DYNAMIC) && defined(LIBNETWRK_POISON_VIEWS)
+TEST(serialize, view_lifetime_checks) {
+    libnetwrk::dynamic_buffer buffer;
+
+    std::string_view view;
+
+    buffer << std::string("abc") >> view;
+    buffer.clear();
+
+    EXPECT_TRUE(buffer.underlying().capacity() >= 7U);
+    EXPECT_TRUE(view[0] == static_cast<char>(0xDD));
+
+    // Growing moves out of the poisoned storage, the data is kept
+    buffer << std::string("abc") >> view;
+    buffer.reserve_additional(4096U);
+
+    EXPECT_TRUE(buffer.size() == 7U);
+    EXPECT_TRUE(buffer.data()[4] == 'a');
+
+    // Views follow small buffers on move too, the moved to buffer poisons them
+    libnetwrk::dynamic_buffer small;
+    small << std::string("abc") >> view;
+
+    {
+        libnetwrk::dynamic_buffer moved(std::move(small));
+
+        EXPECT_TRUE(view == "abc");
+        EXPECT_TRUE(moved.data()[4] == 'a');
+
+        moved.clear();
+        EXPECT_TRUE(view[0] == static_cast<char>(0xDD));
+    }
+
+    // Growing by writing, the arena keeps the old storage readable
+    std::pmr::monotonic_buffer_resource arena;
+    libnetwrk::dynamic_buffer           written(&arena);
+
+    written.reserve_additional(256U);
+    written << std::string("abc") >> view;
+    written << std::string(4096U, 'x');
+
+    EXPECT_TRUE(view[0] == static_cast<char>(0xDD));
+    EXPECT_TRUE(written.data()[4] == 'a');
+}
+#endif
+
+TEST(serialize, try_deserialize) {
+    __BUFFER buffer;
+
+    {
+        derived_struct v1{};
+        derived_struct v2{ 69, "", { 567, 8910 }, false };
+
+        buffer << v1;
+        EXPECT_TRUE(serialize::try_deserialize(buffer, v2) == deserialize_error::none);
+        EXPECT_TRUE(v1 == v2);
+    }
+
+    buffer.clear();
+
+    {
+        // Truncated in the middle of a nested user type
+        std::string    v1 = "abcde";
+        derived_struct v2{};
+
+        buffer << uint32_t(1) << v1 << uint32_t(100) << int(1);
+        EXPECT_TRUE(serialize::try_deserialize(buffer, v2) == deserialize_error::out_of_bounds);
+
+        // Throwing out of the user type leaves no decode state behind
+        get_buffer_read_index(buffer) = 0U;
+        EXPECT_THROW(buffer >> v2, libnetwrk::libnetwrk_exception);
+        EXPECT_TRUE(get_buffer_decode_state(buffer) == nullptr);
+
+        get_buffer_read_index(buffer) = 0U;
+        EXPECT_TRUE(serialize::try_deserialize(buffer, v2) == deserialize_error::out_of_bounds);
+    }
+
+    buffer.clear();
+
+    {
+        // Bogus element count ends at the first failed element
+        std::list<std::string> v1;
+
+        buffer << UINT32_MAX << std::string("a");
+        EXPECT_TRUE(serialize::try_deserialize(buffer, v1) == deserialize_error::out_of_bounds);
+        EXPECT_TRUE(v1.size() <= 2U);
+    }
+
+    buffer.clear();
+
+    {
+        std::array<int, 3> v1{};
+
+        buffer << std::array<int, 2>{ 1, 2 };
+        EXPECT_TRUE(serialize::try_deserialize(buffer, v1) == deserialize_error::size_mismatch);
+    }
+
+    buffer.clear();
+
+    {
+        varint<uint8_t> v1;
+
+        buffer << varint<uint16_t>(300U);
+        EXPECT_TRUE(serialize::try_deserialize(buffer, v1) == deserialize_error::out_of_range);
+    }
+
+    buffer.clear();
+
+    {
+        varint<uint64_t> v1;
+
+        for (int i = 0; i < 10; i++)
+            buffer << uint8_t(0xFF);
+
+        EXPECT_TRUE(serialize::try_deserialize(buffer, v1) == deserialize_error::malformed);
+    }
+
+    buffer.clear();
+
+    {
+        // The throwing path is unchanged and the error doesn't stick
+        uint64_t v1 = 0U;
+        uint32_t v2 = 0U;
+
+        buffer << uint32_t(7);
+        EXPECT_THROW(buffer >> v1, libnetwrk::libnetwrk_exception);
+        EXPECT_TRUE(serialize::try_deserialize(buffer, v2) == deserialize_error::none);
+        EXPECT_TRUE(v2 == 7U);
+    }
+}
+
+TEST(serialize, length_limits) {
+    __BUFFER buffer;
+
+    {
+        // Length prefixes can't claim more than the bytes left
+        std::string v1 = "keep";
+
+        buffer << uint32_t(1U << 30) << uint32_t(0);
+        EXPECT_TRUE(serialize::try_deserialize(buffer, v1) == deserialize_error::out_of_bounds);
+        EXPECT_TRUE(v1 == "keep");
+    }
+
+    buffer.clear();
+
+    {
+        // Count times element size wraps around in 32 bits
+        std::vector<uint64_t> v1;
+
+        buffer << uint32_t(0x20000001U) << uint64_t(0);
+        EXPECT_TRUE(serialize::try_deserialize(buffer, v1) == deserialize_error::out_of_bounds);
+        EXPECT_TRUE(v1.capacity() == 0U);
+    }
+
+    buffer.clear();
+
+    {
+        // User types count as at least a byte each
+        std::vector<base_struct> v1;
+
+        buffer << uint32_t(0x10000000U) << uint32_t(0);
+        EXPECT_TRUE(serialize::try_deserialize(buffer, v1) == deserialize_error::out_of_bounds);
+        EXPECT_TRUE(v1.capacity() == 0U);
+    }
+
+    buffer.clear();
+
+    {
+        std::vector<std::string> v1;
+        std::map<int, std::string> v2;
+
+        buffer << uint32_t(1000) << std::string("a");
+        EXPECT_TRUE(serialize::try_deserialize(buffer, v1) == deserialize_error::out_of_bounds);
+        EXPECT_TRUE(v1.capacity() == 0U);
+
+        get_buffer_read_index(buffer) = 0U;
+        EXPECT_TRUE(serialize::try_deserialize(buffer, v2) == deserialize_error::out_of_bounds);
+        EXPECT_TRUE(v2.empty());
+    }
+
+#ifdef LIBNETWRK_SERIALIZE_TEST_BUFFER_DYNAMIC
+    // Only dynamic buffers, which hold received messages, carry limits
+    buffer.clear();
+
+    {
+        std::vector<int> v1;
+
+        buffer.set_deserialize_limits({ .max_elements = 2U });
+        buffer << std::vector<int>{ 1, 2 } << std::vector<int>{ 1, 2, 3 };
+
+        EXPECT_TRUE(serialize::try_deserialize(buffer, v1) == deserialize_error::none);
+        EXPECT_TRUE(serialize::try_deserialize(buffer, v1) == deserialize_error::over_limit);
+    }
+
+    buffer.clear();
+
+    {
+        // The budget covers one call, including what user types read from inside it
+        std::string    v1;
+        derived_struct v2;
+
+        v2.b = "0123456789";
+        v2.c = { 1, 2 };
+
+        buffer.set_deserialize_limits({ .max_allocation = 16U });
+        buffer << std::string("0123456789") << std::string("0123456789") << v2;
+
+        EXPECT_TRUE(serialize::try_deserialize(buffer, v1) == deserialize_error::none);
+        EXPECT_TRUE(serialize::try_deserialize(buffer, v1) == deserialize_error::none);
+        EXPECT_TRUE(serialize::try_deserialize(buffer, v2) == deserialize_error::over_limit);
+    }
+
+    buffer.clear();
+
+    {
+        // Elements without wire bytes are only bounded by the budget
+        std::vector<empty_struct> v1;
+
+        buffer.set_deserialize_limits({ .max_allocation_ratio = 64U });
+        buffer << uint32_t(1000000);
+
+        EXPECT_TRUE(serialize::try_deserialize(buffer, v1) == deserialize_error::over_limit);
+        EXPECT_TRUE(v1.empty());
+
+        buffer.clear();
+        buffer << uint32_t(100);
+
+        EXPECT_TRUE(serialize::try_deserialize(buffer, v1) == deserialize_error::none);
+        EXPECT_TRUE(v1.size() == 100U);
+    }
+#endif
+}
+
+TEST(serialize, pmr_containers) {
+    __BUFFER buffer;
+
+    std::pmr::monotonic_buffer_resource resource;
+
+    std::pmr::string                               v1("abcde", &resource);
+    std::pmr::vector<std::pmr::string>             v2({ "a", "bc", "def" }, &resource);
+    std::pmr::list<int>                            v3({ 1, 2, 3 }, &resource);
+    std::pmr::set<int>                             v4({ 4, 5, 6 }, &resource);
+    std::pmr::map<int, std::pmr::string>           v5({ { 1, "one" }, { 2, "two" } }, &resource);
+    std::pmr::unordered_map<int, std::pmr::string> v6({ { 3, "three" } }, &resource);
+
+    buffer << v1 << v2 << v3 << v4 << v5 << v6;
+
+    std::pmr::string                               r1(&resource);
+    std::pmr::vector<std::pmr::string>             r2(&resource);
+    std::pmr::list<int>                            r3(&resource);
+    std::pmr::set<int>                             r4(&resource);
+    std::pmr::map<int, std::pmr::string>           r5(&resource);
+    std::pmr::unordered_map<int, std::pmr::string> r6(&resource);
+
+    buffer >> r1 >> r2 >> r3 >> r4 >> r5 >> r6;
+
+    EXPECT_TRUE(v1 == r1);
+    EXPECT_TRUE(v2 == r2);
+    EXPECT_TRUE(v3 == r3);
+    EXPECT_TRUE(v4 == r4);
+    EXPECT_TRUE(v5 == r5);
+    EXPECT_TRUE(v6 == r6);
+
+    // Elements are allocated from the container's resource
+    EXPECT_TRUE(r2[0].get_allocator().resource() == &resource);
+    EXPECT_TRUE(r5[1].get_allocator().resource() == &resource);
+
+    // Wire format is the same as the std containers
+    std::vector<std::string> r7;
+
+    get_buffer_read_index(buffer) = (uint32_t)(sizeof(uint32_t) + v1.size());
+    buffer >> r7;
+
+    EXPECT_TRUE(r7 == std::vector<std::string>({ "a", "bc", "def" }));
+}
+
+#ifdef LIBNETWRK_SERIALIZE_TEST_BUFFER_DYNAMIC
+enum class pmr_commands : uint32_t {
+    none
+};
+
+struct pmr_desc {
+    using command_t = pmr_commands;
+};
+
+TEST(serialize, pmr_buffer) {
+    alignas(std::max_align_t) std::array<std::byte, 4096> arena;
+
+    // Fails instead of falling back to the heap
+    std::pmr::monotonic_buffer_resource resource(arena.data(), arena.size(), std::pmr::null_memory_resource());
+
+    auto in_arena = [&](const void* data) {
+        return data >= arena.data() && data < arena.data() + arena.size();
+    };
+
+    // Larger than the inline storage
+    std::string text(100U, 'x');
+
+    {
+        libnetwrk::dynamic_buffer buffer(&resource);
+        buffer << text << std::vector<int>{ 1, 2, 3 };
+
+        EXPECT_TRUE(buffer.get_memory_resource() == &resource);
+        EXPECT_TRUE(in_arena(buffer.data()));
+
+        // Moves keep the resource, copies use the default one
+        libnetwrk::dynamic_buffer moved(std::move(buffer));
+        libnetwrk::dynamic_buffer copied(moved);
+
+        EXPECT_TRUE(in_arena(moved.data()));
+        EXPECT_TRUE(copied.get_memory_resource() == std::pmr::get_default_resource());
+        EXPECT_TRUE(copied.size() == moved.size());
+    }
+
+    {
+        libnetwrk::message<pmr_desc> message(pmr_commands::none, &resource);
+        message << text;
+
+        EXPECT_TRUE(in_arena(message.data.data()));
+
+        // Queued messages are copied out of the arena
+        libnetwrk::outgoing_message<pmr_desc> outgoing(std::move(message));
+
+        EXPECT_FALSE(in_arena(outgoing.message.data.data()));
+        EXPECT_TRUE(outgoing.message.data.size() == 104U);
+    }
+}
+#endif
+
+#ifdef LIBNETWRK_SERIALIZE_TEST_BUFFER_DYNAMIC
+TEST(serialize, limits_follow_copies) {
+    // Received messages are moved into a queue and copied out to the handler
+    std::vector<int> v1;
+
+    libnetwrk::dynamic_buffer buffer;
+    buffer.set_deserialize_limits({ .max_elements = 2U });
+    buffer << std::vector<int>{ 1, 2, 3 };
+
+    libnetwrk::dynamic_buffer copied(buffer);
+    libnetwrk::dynamic_buffer assigned;
+
+    assigned = std::move(buffer);
+
+    EXPECT_TRUE(serialize::try_deserialize(copied, v1) == deserialize_error::over_limit);
+    EXPECT_TRUE(serialize::try_deserialize(assigned, v1) == deserialize_error::over_limit);
+
+    libnetwrk::message<pmr_desc> message;
+    message.data.set_deserialize_limits({ .max_elements = 2U });
+    message << std::vector<int>{ 1, 2, 3 };
+
+    libnetwrk::message<pmr_desc> message_copied(message);
+    libnetwrk::message<pmr_desc> message_assigned;
+
+    message_assigned = std::move(message);
+
+    EXPECT_TRUE(message_copied.try_read(v1) == deserialize_error::over_limit);
+    EXPECT_TRUE(message_assigned.try_read(v1) == deserialize_error::over_limit);
+}
+#endif
+
+#ifdef LIBNETWRK_SERIALIZE_TEST_BUFFER_DYNAMIC
+TEST(serialize, small_buffer) {
+    auto is_inside = [](libnetwrk::dynamic_buffer& buffer) {
+        auto object = static_cast<void*>(&buffer);
+        auto data   = static_cast<void*>(buffer.data());
+
+        return data >= object && data < static_cast<void*>(reinterpret_cast<uint8_t*>(&buffer) + sizeof(buffer));
+    };
+
+    // Small messages never touch the resource
+    libnetwrk::dynamic_buffer buffer(std::pmr::null_memory_resource());
+    buffer << uint64_t(1) << std::string("abcdefgh");
+
+    EXPECT_TRUE(is_inside(buffer));
+    EXPECT_TRUE(buffer.underlying().capacity() == libnetwrk::byte_vector::inline_capacity);
+
+    {
+        libnetwrk::dynamic_buffer moved(std::move(buffer));
+
+        uint64_t    v1 = 0U;
+        std::string v2;
+
+        moved >> v1 >> v2;
+
+        EXPECT_TRUE(is_inside(moved));
+        EXPECT_TRUE(v1 == 1U && v2 == "abcdefgh");
+        EXPECT_TRUE(buffer.size() == 0U);
+    }
+
+    {
+        // Spills to the heap when exceeded
+        libnetwrk::dynamic_buffer large;
+        std::string               v1;
+
+        large << std::string(100U, 'x');
+        EXPECT_FALSE(is_inside(large));
+
+        libnetwrk::dynamic_buffer moved;
+        moved = std::move(large);
+
+        moved >> v1;
+        EXPECT_TRUE(v1 == std::string(100U, 'x'));
+    }
+
+    {
+        libnetwrk::dynamic_buffer received(20U);
+
+        EXPECT_TRUE(received.size() == 20U);
+        EXPECT_TRUE(is_inside(received));
+    }
+}
+#endif
+
+TEST(serialize, underlying_vector_members) {
+    libnetwrk::dynamic_buffer buffer;
+
+    auto& bytes = buffer.underlying();
+    auto  equal = [&bytes](std::vector<uint8_t> expected) {
+        return std::equal(bytes.begin(), bytes.end(), expected.begin(), expected.end());
+    };
+
+    std::vector<uint8_t> source{ 1, 2, 3 };
+    std::list<int>       list{ 7, 8 };
+
+    bytes.assign(source.begin(), source.end());
+    EXPECT_TRUE(equal({ 1, 2, 3 }));
+
+    bytes.insert(bytes.begin(), uint8_t(0));
+    bytes.insert(bytes.end(), list.begin(), list.end());
+    bytes.insert(bytes.begin() + 2, 2U, uint8_t(9));
+    EXPECT_TRUE(equal({ 0, 1, 9, 9, 2, 3, 7, 8 }));
+
+    bytes.erase(bytes.begin() + 2, bytes.begin() + 4);
+    bytes.erase(bytes.begin());
+    bytes.pop_back();
+    EXPECT_TRUE(equal({ 1, 2, 3, 7 }));
+    EXPECT_TRUE(bytes.front() == 1U && bytes.back() == 7U);
+    EXPECT_THROW(bytes.at(4), std::out_of_range);
+
+    // Grows past the inline bytes in the middle of an insert
+    std::vector<uint8_t> large(100U, 5U);
+
+    bytes.insert(bytes.begin() + 1, large.begin(), large.end());
+    EXPECT_TRUE(bytes.size() == 104U);
+    EXPECT_TRUE(bytes[0] == 1U && bytes[100] == 5U && bytes[101] == 2U && bytes[103] == 7U);
+
+    bytes.assign(3U, uint8_t(4));
+    EXPECT_TRUE(equal({ 4, 4, 4 }));
+    EXPECT_TRUE(bytes == libnetwrk::byte_vector(bytes));
+}
@@ -1,6 +1,13 @@
 #include <libnetwrk.hpp>
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
 using namespace libnetwrk;
 using namespace libnetwrk::tcp;
 
@@ -31,8 +38,25 @@ public:
     }
 
     size_t connections() {
+        std::shared_lock<std::shared_mutex> guard(m_comp_connection.connections_mutex);
         return m_comp_connection.connections.size();
     }
+
+    std::chrono::microseconds first_connection_rtt() {
+        std::shared_lock<std::shared_mutex> guard(m_comp_connection.connections_mutex);
+        return m_comp_connection.connections.empty() ? std::chrono::microseconds(0) : (*m_comp_connection.connections.begin())->get_rtt();
+    }
+};
+
+class test_client : public tcp_client<service_desc> {
+public:
+    std::chrono::microseconds rtt() {
+        return m_comp_connection.connection ? m_comp_connection.connection->get_rtt() : std::chrono::microseconds(0);
+    }
+
+    client_settings& get_settings() {
+        return m_context.settings;
+    }
 };
 
 TEST(service_client, storage) {
@@ -72,4 +96,831 @@ TEST(service_client, auth_timeout) {
     EXPECT_TRUE(service.client_connected);
     EXPECT_TRUE(service.client_disconnected);
     EXPECT_TRUE(service.dc_code == libnetwrk::disconnect_code::authentication_failed);
-}
\ No newline at end of file
+}
+
+TEST(service_client, idle_timeout) {
+    test_service service;
+    service.get_settings().gc_freq_sec      = 1;
+    service.get_settings().idle_timeout_sec = 1;
+    service.start("127.0.0.1", 0);
+    service.process_messages_async();
+
+    tcp_client<service_desc> client;
+    client.connect("127.0.0.1", service.get_port());
+    client.process_messages_async();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    EXPECT_TRUE(service.connections() == 1);
+
+    while (service.connections() != 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    EXPECT_TRUE(service.client_disconnected);
+    EXPECT_TRUE(service.dc_code == libnetwrk::disconnect_code::idle_timeout);
+}
+
+TEST(service_client, read_timeout) {
+    test_service service;
+    service.get_settings().gc_freq_sec      = 1;
+    service.get_settings().read_timeout_sec = 1;
+    service.start("127.0.0.1", 0);
+    service.process_messages_async();
+
+    tcp_client<service_desc> client;
+    client.set_message_callback([](auto, auto) {});
+    client.connect("127.0.0.1", service.get_port());
+    client.process_messages_async();
+
+    while (service.connections() != 1) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // Outgoing traffic doesn't keep the connection alive
+    while (service.connections() != 0) {
+        tcp_client<service_desc>::message_t msg(commands::c2s_hello);
+        service.send_all(msg);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    EXPECT_TRUE(service.client_disconnected);
+    EXPECT_TRUE(service.dc_code == libnetwrk::disconnect_code::read_timeout);
+}
+
+TEST(service_client, disconnect_reaped_immediately) {
+    test_service service;
+    service.get_settings().gc_freq_sec = 60;
+    service.start("127.0.0.1", 0);
+    service.process_messages_async();
+
+    tcp_client<service_desc> client;
+    client.connect("127.0.0.1", service.get_port());
+    client.process_messages_async();
+
+    while (service.connections() != 1) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    client.disconnect();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+
+    while (service.connections() != 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    EXPECT_TRUE(service.connections() == 0);
+    EXPECT_TRUE(service.client_disconnected);
+}
+
+TEST(service_client, heartbeat_rtt_service) {
+    test_service service;
+    service.get_settings().heartbeat_interval_sec = 1;
+    service.start("127.0.0.1", 0);
+    service.process_messages_async();
+
+    test_client client;
+    client.get_settings().heartbeat_interval_sec = 0;
+    client.connect("127.0.0.1", service.get_port());
+    client.process_messages_async();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+    while (service.first_connection_rtt().count() == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    EXPECT_TRUE(service.first_connection_rtt().count() > 0);
+    EXPECT_TRUE(client.is_connected());
+}
+
+TEST(service_client, heartbeat_rtt_client) {
+    test_service service;
+    service.get_settings().heartbeat_interval_sec = 0;
+    service.start("127.0.0.1", 0);
+    service.process_messages_async();
+
+    test_client client;
+    client.get_settings().heartbeat_interval_sec = 1;
+    client.connect("127.0.0.1", service.get_port());
+    client.process_messages_async();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+    while (client.rtt().count() == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    EXPECT_TRUE(client.rtt().count() > 0);
+    EXPECT_TRUE(service.connections() == 1);
+}
+
+TEST(service_client, heartbeat_timeout) {
+    test_service service;
+    service.get_settings().heartbeat_interval_sec = 1;
+    service.get_settings().heartbeat_max_missed   = 1;
+    service.get_settings().auth                   = auth_mode::trusted;
+    service.start("127.0.0.1", 0);
+    service.process_messages_async();
+
+    // Client never processes messages so heartbeats go unanswered
+    tcp_client<service_desc> client;
+    client.connect("127.0.0.1", service.get_port());
+
+    while (service.connections() != 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    EXPECT_TRUE(service.client_disconnected);
+    EXPECT_TRUE(service.dc_code == libnetwrk::disconnect_code::heartbeat_timeout);
+}
+
+TEST(service_client, heartbeat_skips_unauthenticated) {
+    test_service service;
+    service.get_settings().heartbeat_interval_sec = 1;
+    service.get_settings().heartbeat_max_missed   = 1;
+    service.get_settings().auth_deadline_sec      = 3;
+    service.start("127.0.0.1", 0);
+    service.process_messages_async();
+
+    // Client never answers the challenge, the auth deadline disconnects it instead
+    tcp_client<service_desc> client;
+    client.connect("127.0.0.1", service.get_port());
+
+    while (service.connections() != 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    EXPECT_TRUE(service.client_disconnected);
+    EXPECT_TRUE(service.dc_code == libnetwrk::disconnect_code::authentication_failed);
+}
+
+static size_t connect_clients(test_service& service, std::vector<std::unique_ptr<tcp_client<service_desc>>>& clients, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        clients.push_back(std::make_unique<tcp_client<service_desc>>());
+        clients.back()->connect("127.0.0.1", service.get_port());
+    }
+
+    // Shed clients get reset right after connecting
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+
+    while (std::chrono::steady_clock::now() < deadline) {
+        size_t connected = std::count_if(clients.begin(), clients.end(), [](auto& client) { return client->is_connected(); });
+
+        if (connected == service.connections())
+            break;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    return service.connections();
+}
+
+TEST(service_client, max_connections) {
+    test_service service;
+    service.get_settings().max_connections = 2;
+    service.start("127.0.0.1", 0);
+
+    std::vector<std::unique_ptr<tcp_client<service_desc>>> clients;
+    EXPECT_TRUE(connect_clients(service, clients, 4) == 2);
+
+    // Slots free up after disconnecting
+    clients.clear();
+
+    while (service.connections() != 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    EXPECT_TRUE(connect_clients(service, clients, 1) == 1);
+}
+
+TEST(service_client, max_connections_per_ip) {
+    test_service service;
+    service.get_settings().max_connections_per_ip = 3;
+    service.start("127.0.0.1", 0);
+
+    std::vector<std::unique_ptr<tcp_client<service_desc>>> clients;
+    EXPECT_TRUE(connect_clients(service, clients, 5) == 3);
+}
+
+TEST(service_client, accept_rate) {
+    test_service service;
+    service.get_settings().accept_rate_per_sec = 1;
+    service.get_settings().accept_burst        = 2;
+    service.start("127.0.0.1", 0);
+
+    std::vector<std::unique_ptr<tcp_client<service_desc>>> clients;
+    EXPECT_TRUE(connect_clients(service, clients, 4) == 2);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+
+    EXPECT_TRUE(connect_clients(service, clients, 1) == 3);
+}
+
+TEST(service_client, accept_limits_on_restart) {
+    test_service service;
+    service.get_settings().accept_rate_per_sec = 1;
+    service.get_settings().accept_burst        = 5;
+    service.start("127.0.0.1", 0);
+
+    std::vector<std::unique_ptr<tcp_client<service_desc>>> clients;
+    EXPECT_TRUE(connect_clients(service, clients, 2) == 2);
+
+    clients.clear();
+    service.stop();
+
+    // Limits are taken on start, tokens left from the last run don't carry over
+    service.get_settings().accept_burst = 1;
+    service.start("127.0.0.1", 0);
+
+    EXPECT_TRUE(connect_clients(service, clients, 3) == 1);
+}
+
+static void send_hellos(tcp_client<service_desc>& client, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        tcp_client<service_desc>::message_t msg(commands::c2s_hello);
+        client.send(msg);
+    }
+}
+
+TEST(service_client, rate_limit_drop) {
+    std::atomic_size_t received = 0U;
+
+    test_service service;
+    service.get_settings().inbound_limit.messages_per_sec = 10;
+    service.get_settings().inbound_limit.action           = rate_limit_action::drop;
+    service.set_message_callback([&](auto, auto) { received++; });
+    service.start("127.0.0.1", 0);
+    service.process_messages_async();
+
+    tcp_client<service_desc> client;
+    client.connect("127.0.0.1", service.get_port());
+    client.process_messages_async();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    send_hellos(client, 100);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+    while (received + service.get_rate_limit_violations() != 100 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    EXPECT_TRUE(received >= 10 && received < 30);
+    EXPECT_TRUE(received + service.get_rate_limit_violations() == 100);
+    EXPECT_TRUE(client.is_connected());
+}
+
+TEST(service_client, rate_limit_delay) {
+    std::atomic_size_t received = 0U;
+
+    test_service service;
+    service.get_settings().inbound_limit.messages_per_sec = 20;
+    service.get_settings().inbound_limit.action           = rate_limit_action::delay;
+    service.set_message_callback([&](auto, auto) { received++; });
+    service.start("127.0.0.1", 0);
+    service.process_messages_async();
+
+    tcp_client<service_desc> client;
+    client.connect("127.0.0.1", service.get_port());
+    client.process_messages_async();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    auto start = std::chrono::steady_clock::now();
+    send_hellos(client, 40);
+
+    while (received != 40 && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    // First 20 pass on the burst, the rest is paced at 20/s
+    EXPECT_TRUE(received == 40);
+    EXPECT_TRUE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(800));
+    EXPECT_TRUE(service.get_rate_limit_violations() > 0);
+}
+
+TEST(service_client, rate_limit_delay_oversized) {
+    std::atomic_size_t received = 0U;
+
+    test_service service;
+    service.get_settings().inbound_limit.bytes_per_sec = 1024;
+    service.get_settings().inbound_limit.action        = rate_limit_action::delay;
+    service.set_message_callback([&](auto, auto) { received++; });
+    service.start("127.0.0.1", 0);
+    service.process_messages_async();
+
+    tcp_client<service_desc> client;
+    client.connect("127.0.0.1", service.get_port());
+    client.process_messages_async();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    // A minute worth of bytes each, every one is delayed by a second at most
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < 3; i++) {
+        tcp_client<service_desc>::message_t msg(commands::c2s_hello);
+        msg << std::string(60 * 1024, 'a');
+        client.send(msg);
+    }
+
+    while (received != 3 && std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    EXPECT_TRUE(received == 3);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    EXPECT_TRUE(client.is_connected());
+}
+
+TEST(service_client, rate_limit_disconnect) {
+    test_service service;
+    service.get_settings().inbound_limit.bytes_per_sec = 1024;
+    service.get_settings().inbound_limit.action        = rate_limit_action::disconnect;
+    service.set_message_callback([](auto, auto) {});
+    service.start("127.0.0.1", 0);
+    service.process_messages_async();
+
+    tcp_client<service_desc> client;
+    client.connect("127.0.0.1", service.get_port());
+    client.process_messages_async();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    // Larger than the burst, the first passes from a full bucket and the second is over the limit
+    for (int i = 0; i < 2; i++) {
+        tcp_client<service_desc>::message_t msg(commands::c2s_hello);
+        msg << std::string(4096, 'a');
+        client.send(msg);
+    }
+
+    while (service.connections() != 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    EXPECT_TRUE(service.dc_code == libnetwrk::disconnect_code::rate_limited);
+    EXPECT_TRUE(service.get_rate_limit_violations() == 1);
+}
+
+TEST(service_client, rate_limit_delay_stop) {
+    test_service service;
+    service.get_settings().inbound_limit.bytes_per_sec = 1024;
+    service.get_settings().inbound_limit.action        = rate_limit_action::delay;
+    service.set_message_callback([](auto, auto) {});
+    service.start("127.0.0.1", 0);
+    service.process_messages_async();
+
+    tcp_client<service_desc> client;
+    client.connect("127.0.0.1", service.get_port());
+    client.process_messages_async();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    // Puts the reader a few seconds into debt
+    tcp_client<service_desc>::message_t msg(commands::c2s_hello);
+    msg << std::string(4096, 'a');
+    client.send(msg);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    auto start = std::chrono::steady_clock::now();
+    service.stop();
+
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+}
+
+TEST(service_client, rate_limit_delay_disconnect_client) {
+    test_service service;
+    service.start("127.0.0.1", 0);
+    service.process_messages_async();
+
+    test_client client;
+    client.get_settings().inbound_limit.bytes_per_sec = 1024;
+    client.get_settings().inbound_limit.action        = rate_limit_action::delay;
+    client.set_message_callback([](auto, auto) {});
+    client.connect("127.0.0.1", service.get_port());
+    client.process_messages_async();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    tcp_service<service_desc>::message_t msg(commands::c2s_hello);
+    msg << std::string(4096, 'a');
+    service.send_all(msg);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    auto start = std::chrono::steady_clock::now();
+    client.disconnect();
+
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+}
+
+TEST(service_client, rate_limit_system_messages) {
+    test_service service;
+    service.get_settings().inbound_limit.messages_per_sec = 10;
+    service.get_settings().inbound_limit.action           = rate_limit_action::disconnect;
+    service.start("127.0.0.1", 0);
+    service.process_messages_async();
+
+    tcp_client<service_desc> client;
+    client.connect("127.0.0.1", service.get_port());
+    client.process_messages_async();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    // System messages have their own budget, a heartbeat flood is over it
+    for (int i = 0; i < 100; i++) {
+        tcp_client<service_desc>::message_t msg{};
+        msg.head.type    = message_type::system;
+        msg.head.command = static_cast<uint64_t>(system_command::heartbeat);
+        msg << get_steady_microseconds_timestamp();
+        client.send(msg);
+    }
+
+    while (service.connections() != 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    EXPECT_TRUE(service.dc_code == libnetwrk::disconnect_code::rate_limited);
+    EXPECT_TRUE(service.get_rate_limit_violations() == 1);
+}
+
+TEST(service_client, unknown_system_command) {
+    test_service service;
+    service.start("127.0.0.1", 0);
+    service.process_messages_async();
+
+    tcp_client<service_desc> client;
+    client.connect("127.0.0.1", service.get_port());
+    client.process_messages_async();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    tcp_client<service_desc>::message_t msg{};
+    msg.head.type    = message_type::system;
+    msg.head.command = 1000U;
+    client.send(msg);
+
+    while (service.connections() != 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    EXPECT_TRUE(service.dc_code == libnetwrk::disconnect_code::protocol_violation);
+}
+
+TEST(service_client, drain) {
+    std::atomic_size_t received = 0U;
+
+    test_service service;
+    service.start("127.0.0.1", 0);
+    service.process_messages_async();
+
+    // Counted on read, the client drops unprocessed messages when the service disconnects it
+    test_client client;
+    client.set_post_process_message_callback([&](dynamic_buffer* data) {
+        if (data->size() >= 1024U) received++;
+    });
+    client.connect("127.0.0.1", service.get_port());
+    client.process_messages_async();
+
+    while (service.connections() != 1) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    for (size_t i = 0; i < 2000; i++) {
+        tcp_client<service_desc>::message_t msg(commands::c2s_hello);
+        msg << std::string(1024, 'a');
+        service.send_all(msg);
+    }
+
+    EXPECT_TRUE(service.drain(std::chrono::seconds(10)));
+    EXPECT_FALSE(service.is_running());
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+    while (received != 2000 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    EXPECT_TRUE(received == 2000);
+}
+
+TEST(service_client, drain_from_io_thread) {
+    tcp_service<service_desc> service;
+    service.start("127.0.0.1", 0);
+
+    std::promise<bool> promise;
+    service.set_connect_callback([&](auto) {
+        // Would wait on the io thread for writes only it can make
+        try {
+            service.drain(std::chrono::seconds(1));
+            promise.set_value(false);
+        }
+        catch (const libnetwrk_exception&) {
+            promise.set_value(true);
+        }
+    });
+
+    test_client client;
+    client.connect("127.0.0.1", service.get_port());
+
+    EXPECT_TRUE(promise.get_future().get());
+}
+
+class stoppable_service : public test_service {
+public:
+    void stop_io_context() {
+        m_context.io_context.stop();
+    }
+};
+
+TEST(service_client, drain_stopped_io_context) {
+    stoppable_service service;
+    service.start("127.0.0.1", 0);
+
+    test_client client;
+    client.connect("127.0.0.1", service.get_port());
+
+    while (service.connections() != 1) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // Nothing is written or closed anymore, drain must give up instead of waiting out the timeout
+    service.stop_io_context();
+
+    tcp_client<service_desc>::message_t msg(commands::c2s_hello);
+    service.send_all(msg);
+
+    auto start = std::chrono::steady_clock::now();
+
+    EXPECT_FALSE(service.drain(std::chrono::seconds(30)));
+    EXPECT_FALSE(service.is_running());
+    EXPECT_TRUE(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+}
+
+struct pooled_desc {
+    using command_t = commands;
+    using storage_t = std::string;
+};
+
+TEST(service_client, connection_pool_reuse) {
+    std::atomic<void*> first  = nullptr;
+    std::atomic<void*> second = nullptr;
+
+    tcp_service<pooled_desc> service;
+    service.get_settings().connection_pool_size   = 4;
+    service.get_settings().connection_pool_warmup = 2;
+
+    service.set_connect_callback([&](auto connection) {
+        EXPECT_TRUE(connection->get_storage().empty());
+        connection->get_storage() = "used";
+
+        void* expected = nullptr;
+        if (!first.compare_exchange_strong(expected, connection.get()))
+            second = connection.get();
+    });
+
+    std::atomic_bool disconnected = false;
+    service.set_disconnect_callback([&](auto, auto) { disconnected = true; });
+
+    service.start("127.0.0.1", 0);
+    service.process_messages_async();
+
+    {
+        tcp_client<pooled_desc> client;
+        client.connect("127.0.0.1", service.get_port());
+
+        while (first == nullptr) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    while (!disconnected) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    tcp_client<pooled_desc> client;
+    client.connect("127.0.0.1", service.get_port());
+
+    while (second == nullptr) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // Released connection is reset and handed out again
+    EXPECT_TRUE(first == second);
+}
+
+TEST(service_client, cached_endpoint) {
+    std::string          ip;
+    std::atomic_uint16_t port         = 0U;
+    std::atomic_bool     connected    = false;
+    std::atomic_bool     disconnected = false;
+
+    tcp_service<service_desc> service;
+    service.set_connect_callback([&](auto) { connected = true; });
+    service.set_disconnect_callback([&](auto connection, auto) {
+        // Socket is already closed here
+        ip           = connection->get_ip();
+        port         = connection->get_port();
+        disconnected = true;
+    });
+
+    service.start("127.0.0.1", 0);
+    service.process_messages_async();
+
+    tcp_client<service_desc> client;
+    client.connect("127.0.0.1", service.get_port());
+
+    while (!connected) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    client.disconnect();
+
+    while (!disconnected) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    EXPECT_TRUE(ip == "127.0.0.1");
+    EXPECT_TRUE(port != 0U);
+}
+
+TEST(service_client, concurrent_accepts) {
+    test_service service;
+    service.get_settings().pending_accepts = 8;
+    service.start("127.0.0.1", 0);
+
+    std::vector<std::unique_ptr<tcp_client<service_desc>>> clients;
+    std::vector<std::future<bool>>                         results;
+
+    for (size_t i = 0; i < 32; i++) {
+        clients.push_back(std::make_unique<tcp_client<service_desc>>());
+        results.push_back(clients.back()->async_connect("127.0.0.1", service.get_port(), asio::use_future));
+    }
+
+    for (auto& result : results)
+        EXPECT_TRUE(result.get());
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+
+    while (service.connections() != 32 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    EXPECT_TRUE(service.connections() == 32);
+}
+
+static size_t wait_for_hellos(std::atomic_size_t& received, size_t count) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+
+    while (received != count && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return received;
+}
+
+TEST(service_client, auth_optimistic) {
+    std::atomic_size_t received = 0U;
+
+    test_service service;
+    service.set_message_callback([&](auto, auto) { received++; });
+    service.start("127.0.0.1", 0);
+    service.process_messages_async();
+
+    test_client client;
+    client.get_settings().auth = auth_mode::optimistic;
+    client.connect("127.0.0.1", service.get_port());
+    client.process_messages_async();
+
+    send_hellos(client, 10);
+
+    EXPECT_TRUE(wait_for_hellos(received, 10) == 10);
+    EXPECT_TRUE(client.is_connected());
+}
+
+TEST(service_client, auth_trusted) {
+    std::atomic_size_t received = 0U;
+
+    test_service service;
+    service.get_settings().auth = auth_mode::trusted;
+    service.set_message_callback([&](auto, auto) { received++; });
+    service.start("127.0.0.1", 0);
+    service.process_messages_async();
+
+    test_client client;
+    client.get_settings().auth = auth_mode::trusted;
+    client.connect("127.0.0.1", service.get_port());
+
+    // Nothing to process on the client, no challenge is sent
+    send_hellos(client, 10);
+
+    EXPECT_TRUE(wait_for_hellos(received, 10) == 10);
+    EXPECT_TRUE(client.is_connected());
+}
+
+TEST(service_client, compact_messages) {
+    std::promise<uint64_t> promise;
+
+    test_service service;
+    service.get_settings().compact = true;
+    service.set_message_callback([&](auto, auto message) {
+        uint64_t value = 0U;
+
+        if (message->message.data.size() == 2U && message->message.try_read(value) == deserialize_error::none)
+            promise.set_value(value);
+        else
+            promise.set_value(0U);
+    });
+    service.start("127.0.0.1", 0);
+    service.process_messages_async();
+
+    test_client client;
+    client.connect("127.0.0.1", service.get_port());
+    client.process_messages_async();
+
+    // 300 takes two bytes as a varint
+    tcp_client<service_desc>::message_t msg(commands::c2s_hello);
+    msg.data.set_compact(true);
+    msg << uint64_t(300U);
+    client.send(msg);
+
+    auto future = promise.get_future();
+
+    ASSERT_TRUE(future.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    EXPECT_TRUE(future.get() == 300U);
+}
+
+TEST(service_client, auth_unverified_messages_dropped) {
+    std::atomic_size_t received = 0U;
+
+    test_service service;
+    service.get_settings().auth_deadline_sec = 60;
+    service.set_message_callback([&](auto, auto) { received++; });
+    service.start("127.0.0.1", 0);
+    service.process_messages_async();
+
+    // Skips the challenge the service expects, refuses it and disconnects
+    test_client client;
+    client.get_settings().auth = auth_mode::trusted;
+    client.connect("127.0.0.1", service.get_port());
+    client.process_messages_async();
+
+    send_hellos(client, 10);
+
+    EXPECT_TRUE(wait_for_hellos(received, 10) == 0);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+    while (service.connections() != 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    EXPECT_TRUE(service.connections() == 0);
+    EXPECT_FALSE(client.is_connected());
+}
+
+TEST(service_client, decode_limits) {
+    std::promise<deserialize_error> service_promise;
+    std::promise<deserialize_error> client_promise;
+
+    // Received messages are copied and moved into the queues, the limits must follow them
+    test_service service;
+    service.get_settings().decode_limits = { .max_elements = 2U };
+    service.set_message_callback([&](auto, auto message) {
+        std::vector<int> values;
+        service_promise.set_value(message->message.try_read(values));
+
+        tcp_service<service_desc>::message_t reply(commands::c2s_hello);
+        reply << std::vector<int>{ 1, 2, 3 };
+        service.send(message->sender, reply);
+    });
+    service.start("127.0.0.1", 0);
+    service.process_messages_async();
+
+    test_client client;
+    client.get_settings().decode_limits = { .max_elements = 2U };
+    client.set_message_callback([&](auto, auto message) {
+        std::vector<int> values;
+        client_promise.set_value(message->message.try_read(values));
+    });
+    client.connect("127.0.0.1", service.get_port());
+    client.process_messages_async();
+
+    tcp_client<service_desc>::message_t msg(commands::c2s_hello);
+    msg << std::vector<int>{ 1, 2, 3 };
+    client.send(msg);
+
+    auto service_future = service_promise.get_future();
+    auto client_future  = client_promise.get_future();
+
+    ASSERT_TRUE(service_future.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    EXPECT_TRUE(service_future.get() == deserialize_error::over_limit);
+
+    ASSERT_TRUE(client_future.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    EXPECT_TRUE(client_future.get() == deserialize_error::over_limit);
+}
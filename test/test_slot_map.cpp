@@ -0,0 +1,80 @@
+#include "libnetwrk/net/containers/slot_map.hpp"
+
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace libnetwrk;
+
+TEST(slot_map, insert_find_erase) {
+    slot_map<std::string> map;
+
+    auto k1 = map.insert("a");
+    auto k2 = map.insert("b");
+    auto k3 = map.insert("c");
+
+    EXPECT_TRUE(k1 == 1 && k2 == 2 && k3 == 3);
+    EXPECT_TRUE(map.size() == 3);
+
+    ASSERT_TRUE(map.find(k2) != nullptr);
+    EXPECT_TRUE(*map.find(k2) == "b");
+
+    EXPECT_TRUE(map.erase(k1));
+    EXPECT_FALSE(map.erase(k1));
+    EXPECT_TRUE(map.find(k1) == nullptr);
+    EXPECT_TRUE(map.size() == 2);
+
+    ASSERT_TRUE(map.find(k3) != nullptr);
+    EXPECT_TRUE(*map.find(k3) == "c");
+
+    EXPECT_TRUE(map.find(0) == nullptr);
+    EXPECT_TRUE(map.find(1234) == nullptr);
+}
+
+TEST(slot_map, stale_keys) {
+    slot_map<int> map;
+
+    auto k1 = map.insert(1);
+    map.erase(k1);
+
+    // Reuses the slot with a new generation
+    auto k2 = map.insert(2);
+    EXPECT_TRUE(k1 != k2);
+    EXPECT_TRUE((uint32_t)k1 == (uint32_t)k2);
+
+    EXPECT_FALSE(map.contains(k1));
+    EXPECT_TRUE(map.contains(k2));
+    EXPECT_TRUE(*map.find(k2) == 2);
+
+    // Never handed out generation of a free slot
+    map.erase(k2);
+    EXPECT_FALSE(map.contains(k2 + (1ULL << 32)));
+}
+
+TEST(slot_map, remove_if) {
+    slot_map<int> map;
+    std::vector<slot_map<int>::key_t> keys;
+
+    for (int i = 0; i < 100; i++)
+        keys.push_back(map.insert(i));
+
+    EXPECT_TRUE(map.remove_if([](int value) { return value % 2 == 0; }) == 50);
+    EXPECT_TRUE(map.size() == 50);
+
+    for (int i = 0; i < 100; i++) {
+        EXPECT_TRUE(map.contains(keys[i]) == (i % 2 != 0));
+
+        if (i % 2 != 0) {
+            EXPECT_TRUE(*map.find(keys[i]) == i);
+        }
+    }
+
+    int sum = 0;
+    for (int value : map)
+        sum += value;
+
+    EXPECT_TRUE(sum == 2500);
+
+    map.clear();
+    EXPECT_TRUE(map.empty());
+    EXPECT_FALSE(map.contains(keys[1]));
+}
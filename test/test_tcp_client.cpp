@@ -1,6 +1,9 @@
 #include <libnetwrk.hpp>
 #include <gtest/gtest.h>
 
+#include <future>
+#include <chrono>
+
 enum class commands : int {
     hello,
 };
@@ -21,3 +24,64 @@ TEST(tcp_client, connect_fail) {
     libnetwrk::tcp::tcp_client<service_desc> client;
     EXPECT_FALSE(client.connect("127.0.0.1", 21205));
 }
+
+TEST(tcp_client, async_connect_fail) {
+    libnetwrk::tcp::tcp_client<service_desc> client;
+
+    std::promise<bool> promise;
+    client.async_connect("127.0.0.1", 21205, [&](bool connected) {
+        promise.set_value(connected);
+    });
+
+    EXPECT_FALSE(promise.get_future().get());
+    EXPECT_FALSE(client.is_connected());
+}
+
+TEST(tcp_client, co_connect_fail) {
+    libnetwrk::tcp::tcp_client<service_desc> client;
+
+    asio::io_context context;
+    auto result = asio::co_spawn(context, client.co_connect("127.0.0.1", 21205), asio::use_future);
+    context.run();
+
+    EXPECT_FALSE(result.get());
+    EXPECT_FALSE(client.is_connected());
+}
+
+TEST(tcp_client, connect_timeout) {
+    libnetwrk::tcp::tcp_client<service_desc> client;
+    client.get_settings().connect_timeout_ms = 500U;
+
+    // Non-routable address, either times out or fails right away without a route
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(client.connect("10.255.255.1", 21205));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+}
+
+TEST(tcp_client, connector_restaggers_after_failure) {
+    using namespace std::chrono_literals;
+
+    asio::io_context        context;
+    asio::ip::tcp::acceptor acceptor(context, { asio::ip::address_v4::loopback(), 0 });
+
+    // Refused right away, then one that hangs or fails, then the listener
+    std::vector<asio::ip::tcp::endpoint> endpoints = {
+        { asio::ip::address_v4::loopback(), 21205 },
+        { asio::ip::make_address("10.255.255.1"), 21205 },
+        acceptor.local_endpoint()
+    };
+
+    std::error_code ec = asio::error::would_block;
+
+    auto start = std::chrono::steady_clock::now();
+    asio::co_spawn(context, [&]() -> asio::awaitable<void> {
+        auto [result, socket] = co_await libnetwrk::tcp::tcp_connector::co_connect(context, endpoints, 5000ms, 1000ms);
+        ec = result;
+    }, asio::detached);
+
+    context.run();
+    EXPECT_FALSE(ec);
+
+    // The listener starts one delay after the early failure, not two delays after the first attempt
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 1800ms);
+}
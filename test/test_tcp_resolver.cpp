@@ -0,0 +1,163 @@
+#include <libnetwrk.hpp>
+#include <gtest/gtest.h>
+
+using namespace libnetwrk;
+
+TEST(tcp_resolver, literals) {
+    asio::io_context context;
+    tcp_resolver     resolver(context);
+
+    std::vector<tcp_resolver::endpoint_t> endpoints;
+
+    EXPECT_TRUE(resolver.get_endpoints("127.0.0.1", 21205, endpoints));
+    ASSERT_TRUE(endpoints.size() == 1);
+    EXPECT_TRUE(endpoints[0] == tcp_resolver::endpoint_t(asio::ip::make_address("127.0.0.1"), 21205));
+
+    EXPECT_TRUE(resolver.get_endpoints("::1", 21205, endpoints));
+    ASSERT_TRUE(endpoints.size() == 1);
+    EXPECT_TRUE(endpoints[0].protocol() == asio::ip::tcp::v6());
+
+    EXPECT_TRUE(resolver.get_endpoints("[::1]", 21205, endpoints));
+    ASSERT_TRUE(endpoints.size() == 1);
+    EXPECT_TRUE(endpoints[0].protocol() == asio::ip::tcp::v6());
+
+    EXPECT_TRUE(resolver.get_endpoints("localhost", 21205, endpoints));
+    ASSERT_TRUE(endpoints.size() == 2);
+    EXPECT_TRUE(endpoints[0] == tcp_resolver::endpoint_t(asio::ip::address_v4::loopback(), 21205));
+    EXPECT_TRUE(endpoints[1] == tcp_resolver::endpoint_t(asio::ip::address_v6::loopback(), 21205));
+
+    // Single endpoint still prefers IPv4
+    tcp_resolver::endpoint_t endpoint;
+    EXPECT_TRUE(resolver.get_endpoint("localhost", 21205, endpoint));
+    EXPECT_TRUE(endpoint.protocol() == asio::ip::tcp::v4());
+
+    EXPECT_TRUE(resolver.get_endpoints("tcp://127.0.0.1/", 21205, endpoints));
+    ASSERT_TRUE(endpoints.size() == 1);
+    EXPECT_TRUE(endpoints[0].port() == 21205);
+
+    EXPECT_FALSE(resolver.get_endpoints("", 21205, endpoints));
+    EXPECT_FALSE(resolver.get_endpoints("tcp://", 21205, endpoints));
+}
+
+TEST(tcp_resolver, host_with_port) {
+    asio::io_context context;
+    tcp_resolver     resolver(context);
+
+    std::vector<tcp_resolver::endpoint_t> endpoints;
+
+    EXPECT_TRUE(resolver.get_endpoints("[::1]:80", 21205, endpoints));
+    ASSERT_TRUE(endpoints.size() == 1);
+    EXPECT_TRUE(endpoints[0].protocol() == asio::ip::tcp::v6());
+    EXPECT_TRUE(endpoints[0].port() == 21205);
+
+    EXPECT_TRUE(resolver.get_endpoints("tcp://127.0.0.1:80/path", 21205, endpoints));
+    ASSERT_TRUE(endpoints.size() == 1);
+    EXPECT_TRUE(endpoints[0].port() == 21205);
+
+    EXPECT_FALSE(resolver.get_endpoints("[::1", 21205, endpoints));
+    EXPECT_FALSE(resolver.get_endpoints("[::1]x", 21205, endpoints));
+    EXPECT_FALSE(resolver.get_endpoints("127.0.0.1:port", 21205, endpoints));
+}
+
+TEST(tcp_resolver, cache) {
+    asio::io_context context;
+    tcp_resolver     resolver(context);
+
+    tcp_resolver::clear_cache();
+
+    std::vector<tcp_resolver::endpoint_t> endpoints;
+
+    // Seeded entries are served without a lookup
+    tcp_resolver::set_cached("libnetwrk.test", { asio::ip::make_address("127.0.0.2") });
+    EXPECT_TRUE(tcp_resolver::is_cached("tcp://libnetwrk.test:80"));
+    EXPECT_TRUE(resolver.get_endpoints("libnetwrk.test", 21205, endpoints));
+    ASSERT_TRUE(endpoints.size() == 1);
+    EXPECT_TRUE(endpoints[0] == tcp_resolver::endpoint_t(asio::ip::make_address("127.0.0.2"), 21205));
+
+    tcp_resolver::clear_cache();
+    EXPECT_FALSE(tcp_resolver::is_cached("libnetwrk.test"));
+}
+
+TEST(tcp_resolver, negative_cache) {
+    asio::io_context context;
+    tcp_resolver     resolver(context);
+
+    tcp_resolver::clear_cache();
+
+    std::vector<tcp_resolver::endpoint_t> endpoints;
+
+    tcp_resolver::set_cached("libnetwrk.invalid", {}, asio::error::host_not_found);
+    EXPECT_TRUE(tcp_resolver::is_cached("libnetwrk.invalid"));
+    EXPECT_FALSE(resolver.get_endpoints("libnetwrk.invalid", 21205, endpoints));
+    EXPECT_TRUE(endpoints.empty());
+
+    // May succeed on retry
+    tcp_resolver::set_cached("again.invalid", {}, asio::error::host_not_found_try_again);
+    tcp_resolver::set_cached("aborted.invalid", {}, asio::error::operation_aborted);
+    EXPECT_FALSE(tcp_resolver::is_cached("again.invalid"));
+    EXPECT_FALSE(tcp_resolver::is_cached("aborted.invalid"));
+
+    tcp_resolver::clear_cache();
+}
+
+TEST(tcp_resolver, cache_bound) {
+    auto settings = tcp_resolver::get_settings();
+
+    tcp_resolver::clear_cache();
+    tcp_resolver::set_settings({ .max_cache_entries = 2U });
+
+    tcp_resolver::set_cached("a.test", { asio::ip::make_address("127.0.0.1") });
+    tcp_resolver::set_cached("b.test", { asio::ip::make_address("127.0.0.1") });
+    tcp_resolver::set_cached("c.test", { asio::ip::make_address("127.0.0.1") });
+
+    // The entry closest to expiring goes first
+    EXPECT_FALSE(tcp_resolver::is_cached("a.test"));
+    EXPECT_TRUE(tcp_resolver::is_cached("b.test"));
+    EXPECT_TRUE(tcp_resolver::is_cached("c.test"));
+
+    tcp_resolver::set_settings({ .max_cache_entries = 0U });
+    EXPECT_FALSE(tcp_resolver::is_cached("c.test"));
+
+    tcp_resolver::set_cached("d.test", { asio::ip::make_address("127.0.0.1") });
+    EXPECT_FALSE(tcp_resolver::is_cached("d.test"));
+
+    tcp_resolver::set_settings(settings);
+}
+
+TEST(tcp_resolver, co_get_endpoints) {
+    asio::io_context context;
+    tcp_resolver     resolver(context);
+
+    auto result = asio::co_spawn(context, resolver.co_get_endpoints("127.0.0.1", 21205), asio::use_future);
+    context.run();
+
+    auto [ec, endpoints] = result.get();
+    EXPECT_FALSE(ec);
+    ASSERT_TRUE(endpoints.size() == 1);
+    EXPECT_TRUE(endpoints[0].port() == 21205);
+}
+
+TEST(tcp_resolver, co_get_endpoints_timeout) {
+    asio::io_context context;
+
+    auto result = asio::co_spawn(context,
+        tcp_resolver::co_get_endpoints(context, "127.0.0.1", 21205, std::chrono::milliseconds(1000)), asio::use_future);
+    context.run();
+
+    auto [ec, endpoints] = result.get();
+    EXPECT_FALSE(ec);
+    ASSERT_TRUE(endpoints.size() == 1);
+    EXPECT_TRUE(endpoints[0].port() == 21205);
+
+    // Nothing resolves within no time, the lookup is left behind
+    tcp_resolver::clear_cache();
+    context.restart();
+
+    result = asio::co_spawn(context,
+        tcp_resolver::co_get_endpoints(context, "timeout.invalid", 21205, std::chrono::milliseconds(0)), asio::use_future);
+    context.run();
+
+    std::tie(ec, endpoints) = result.get();
+    EXPECT_TRUE(ec);
+    EXPECT_TRUE(endpoints.empty());
+}
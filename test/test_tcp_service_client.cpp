@@ -3,6 +3,7 @@
 
 #include <thread>
 #include <chrono>
+#include <future>
 
 using namespace libnetwrk::tcp;
 using namespace libnetwrk;
@@ -228,6 +229,71 @@ TEST(tcp_service_client, connect) {
         test_client client;
         EXPECT_TRUE(client.connect("localhost", service.get_port()));
     }
+
+    {
+        // localhost reaches a service listening on the IPv6 loopback, where there is one
+        test_service service;
+
+        if (service.start("::1", 0)) {
+            test_client client;
+            EXPECT_TRUE(client.connect("localhost", service.get_port()));
+        }
+    }
+}
+
+TEST(tcp_service_client, async_connect) {
+    test_service service;
+    EXPECT_TRUE(service.start("127.0.0.1", 0));
+
+    test_client client1;
+    test_client client2;
+
+    std::promise<bool> promise1;
+    std::promise<bool> promise2;
+
+    client1.async_connect("127.0.0.1", service.get_port(), [&](bool connected) { promise1.set_value(connected); });
+    client2.async_connect("127.0.0.1", service.get_port(), [&](bool connected) { promise2.set_value(connected); });
+
+    EXPECT_TRUE(promise1.get_future().get());
+    EXPECT_TRUE(promise2.get_future().get());
+    EXPECT_TRUE(client1.is_connected());
+    EXPECT_TRUE(client2.is_connected());
+}
+
+TEST(tcp_service_client, co_connect) {
+    test_service service;
+    EXPECT_TRUE(service.start("127.0.0.1", 0));
+
+    test_client client;
+
+    asio::io_context context;
+    auto result = asio::co_spawn(context, client.co_connect("127.0.0.1", service.get_port()), asio::use_future);
+    context.run();
+
+    EXPECT_TRUE(result.get());
+    EXPECT_TRUE(client.is_connected());
+}
+
+TEST(tcp_service_client, connect_from_io_thread) {
+    test_service service;
+    EXPECT_TRUE(service.start("127.0.0.1", 0));
+
+    test_client client;
+
+    std::promise<bool> promise;
+    client.set_connect_callback([&](auto) {
+        // Would deadlock waiting for itself
+        try {
+            client.connect("127.0.0.1", service.get_port());
+            promise.set_value(false);
+        }
+        catch (const libnetwrk_exception&) {
+            promise.set_value(true);
+        }
+    });
+
+    EXPECT_TRUE(client.connect("127.0.0.1", service.get_port()));
+    EXPECT_TRUE(promise.get_future().get());
 }
 
 TEST(tcp_service_client, hello) {
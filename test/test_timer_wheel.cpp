@@ -0,0 +1,127 @@
+#include "libnetwrk/net/misc/timer_wheel.hpp"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace libnetwrk;
+
+TEST(timer_wheel, fires_on_expiry) {
+    timer_wheel<int> wheel;
+    std::vector<int> fired;
+
+    wheel.schedule(1, 1);
+    wheel.schedule(5, 5);
+    wheel.schedule(64, 64);
+    wheel.schedule(100, 100);
+
+    EXPECT_TRUE(wheel.size() == 4);
+
+    wheel.advance(4, [&](int& value) { fired.push_back(value); });
+    EXPECT_TRUE(fired == std::vector<int>({ 1 }));
+
+    wheel.advance(1, [&](int& value) { fired.push_back(value); });
+    EXPECT_TRUE(fired == std::vector<int>({ 1, 5 }));
+
+    wheel.advance(58, [&](int& value) { fired.push_back(value); });
+    EXPECT_TRUE(fired.size() == 2);
+
+    wheel.advance(1, [&](int& value) { fired.push_back(value); });
+    EXPECT_TRUE(fired == std::vector<int>({ 1, 5, 64 }));
+
+    wheel.advance(36, [&](int& value) { fired.push_back(value); });
+    EXPECT_TRUE(fired == std::vector<int>({ 1, 5, 64, 100 }));
+    EXPECT_TRUE(wheel.size() == 0);
+}
+
+TEST(timer_wheel, cancel) {
+    timer_wheel<int> wheel;
+    size_t           fired = 0U;
+
+    auto t1 = wheel.schedule(10, 1);
+    auto t2 = wheel.schedule(10, 2);
+
+    EXPECT_TRUE(wheel.cancel(t1));
+    EXPECT_FALSE(wheel.cancel(t1));
+    EXPECT_FALSE(wheel.cancel(timer_wheel<int>::invalid_timer));
+
+    wheel.advance(10, [&](int& value) {
+        EXPECT_TRUE(value == 2);
+        fired++;
+    });
+
+    EXPECT_TRUE(fired == 1);
+    EXPECT_FALSE(wheel.cancel(t2));
+
+    // Reused node must not match the stale id
+    auto t3 = wheel.schedule(3, 3);
+    EXPECT_FALSE(wheel.cancel(t2));
+    EXPECT_TRUE(wheel.cancel(t3));
+}
+
+TEST(timer_wheel, reschedule_from_callback) {
+    timer_wheel<int> wheel;
+    size_t           fired = 0U;
+
+    wheel.schedule(2, 0);
+
+    wheel.advance(20, [&](int& value) {
+        fired++;
+
+        if (value < 4)
+            wheel.schedule(3, value + 1);
+    });
+
+    EXPECT_TRUE(fired == 5);
+    EXPECT_TRUE(wheel.size() == 0);
+}
+
+TEST(timer_wheel, cancel_from_callback) {
+    timer_wheel<int> wheel;
+    std::vector<int> fired;
+
+    std::vector<timer_wheel<int>::timer_id_t> ids;
+
+    for (int i = 0; i < 4; i++)
+        ids.push_back(wheel.schedule(5, i));
+
+    // Cancel every sibling in the same bucket from the first callback
+    wheel.advance(5, [&](int& value) {
+        fired.push_back(value);
+
+        for (auto id : ids)
+            wheel.cancel(id);
+    });
+
+    EXPECT_TRUE(fired.size() == 1);
+    EXPECT_TRUE(wheel.size() == 0);
+
+    // Free list must still hand out every node exactly once
+    for (int i = 0; i < 8; i++)
+        wheel.schedule(1, i);
+
+    EXPECT_TRUE(wheel.size() == 8);
+    EXPECT_TRUE(wheel.advance(1, [&](int&) {}) == 8);
+    EXPECT_TRUE(wheel.size() == 0);
+}
+
+TEST(timer_wheel, exact_expiry_across_levels) {
+    timer_wheel<uint64_t, 2U, 3U> wheel;
+
+    // Spans all levels and past the wheel span of 4^3 ticks
+    for (uint64_t delay = 1U; delay < 300U; delay++)
+        wheel.schedule(delay, delay);
+
+    size_t fired = 0U;
+
+    wheel.advance(7, [](uint64_t&) {});
+
+    for (uint64_t i = 8U; i < 310U; i++) {
+        wheel.advance(1, [&](uint64_t& expires) {
+            EXPECT_TRUE(expires == wheel.now());
+            fired++;
+        });
+    }
+
+    EXPECT_TRUE(fired == 299U - 7U);
+    EXPECT_TRUE(wheel.size() == 0);
+}
@@ -0,0 +1,66 @@
+#include "libnetwrk/net/misc/token_bucket.hpp"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+using namespace libnetwrk;
+
+TEST(token_bucket, unlimited) {
+    token_bucket bucket;
+
+    EXPECT_FALSE(bucket.is_limited());
+
+    for (int i = 0; i < 1000; i++)
+        EXPECT_TRUE(bucket.try_consume());
+}
+
+TEST(token_bucket, burst_and_refill) {
+    token_bucket bucket(20.0, 3.0);
+
+    EXPECT_TRUE(bucket.try_consume());
+    EXPECT_TRUE(bucket.try_consume());
+    EXPECT_TRUE(bucket.try_consume());
+    EXPECT_FALSE(bucket.try_consume());
+
+    // 20 tokens per second, one every 50ms
+    std::this_thread::sleep_for(std::chrono::milliseconds(120));
+
+    EXPECT_TRUE(bucket.try_consume());
+    EXPECT_TRUE(bucket.try_consume());
+    EXPECT_FALSE(bucket.try_consume());
+}
+
+TEST(token_bucket, oversized) {
+    token_bucket bucket(100.0, 10.0);
+
+    // Larger than the burst passes from a full bucket and leaves it in debt
+    EXPECT_TRUE(bucket.can_consume(25.0));
+    EXPECT_TRUE(bucket.try_consume(25.0));
+    EXPECT_FALSE(bucket.can_consume(1.0));
+    EXPECT_FALSE(bucket.try_consume(25.0));
+
+    // Debt of 15 plus a full burst of 10 at 100 per second
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+    EXPECT_TRUE(bucket.try_consume(25.0));
+}
+
+TEST(token_bucket, can_consume) {
+    token_bucket bucket(1.0, 2.0);
+
+    EXPECT_TRUE(bucket.can_consume(2.0));
+    EXPECT_TRUE(bucket.can_consume(2.0));
+    EXPECT_TRUE(bucket.try_consume(2.0));
+    EXPECT_FALSE(bucket.can_consume());
+}
+
+TEST(token_bucket, consume_max_debt) {
+    token_bucket bucket(100.0, 10.0);
+
+    // Debt of 990 would take almost 10 seconds, capped at one second of refill
+    uint64_t wait_us = bucket.consume(1000.0, 1.0);
+    EXPECT_TRUE(wait_us > 900000U && wait_us <= 1000000U);
+
+    EXPECT_TRUE(bucket.consume(1.0) > wait_us);
+}